@@ -0,0 +1,1397 @@
+///
+/// micro benchmarks for the portable parts (falg, geometry_mesh, gizmo)
+///
+/// wgut_bench [--csv] [--filter SUBSTRING] [--min-time SECONDS]
+///
+/// writes json (default) or csv to stdout.
+/// the dispatch/* cases run every isa the cpu supports and exit with 1 if one differs from Scalar.
+///
+#include <falg.h>
+#include <falg_dispatch.h>
+#include <wgut/wgut_gizmo.h>
+#include <wgut/TransformStore.h>
+#include <wgut/SceneGraph.h>
+#include <wgut/SceneBvh.h>
+#include <wgut/LooseOctree.h>
+#include <wgut/OcclusionCuller.h>
+#include <wgut/LodSelector.h>
+#include <wgut/KdTree.h>
+#include <wgut/MeshOptimizer.h>
+#include "geometry_mesh.h"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(_MSC_VER)
+    static volatile const void *sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile(""
+                 :
+                 : "r,m"(value)
+                 : "memory");
+#endif
+}
+
+struct Result
+{
+    std::string name;
+    uint64_t iterations;
+    // items processed by one iteration. vertices, matrices...
+    uint64_t items;
+    double ns_per_iteration;
+
+    double ns_per_item() const
+    {
+        return ns_per_iteration / items;
+    }
+};
+
+class Runner
+{
+    std::vector<Result> m_results;
+    std::string m_filter;
+    double m_minSeconds = 0.2;
+
+public:
+    Runner(std::string_view filter, double minSeconds)
+        : m_filter(filter), m_minSeconds(minSeconds)
+    {
+    }
+
+    const std::vector<Result> &Results() const
+    {
+        return m_results;
+    }
+
+    // run f repeatedly. best of 5 rounds of at least min-time / 5
+    void Run(const std::string &name, uint64_t items, const std::function<void()> &f)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+        {
+            return;
+        }
+
+        using clock = std::chrono::steady_clock;
+        f(); // warm up
+
+        // calibrate iterations per round
+        uint64_t iterations = 1;
+        auto roundSeconds = m_minSeconds / 5;
+        while (true)
+        {
+            auto start = clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                f();
+            }
+            std::chrono::duration<double> elapsed = clock::now() - start;
+            if (elapsed.count() >= roundSeconds || iterations >= (1ull << 40))
+            {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        double best = std::numeric_limits<double>::infinity();
+        for (int round = 0; round < 5; ++round)
+        {
+            auto start = clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                f();
+            }
+            std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+            best = std::min(best, elapsed.count() / iterations);
+        }
+        m_results.push_back({name, iterations, items, best});
+    }
+};
+
+void WriteJson(std::ostream &os, const std::vector<Result> &results)
+{
+    os << "{\n  \"isa\": \"" << falg::dispatch::IsaName(falg::dispatch::ActiveIsa()) << "\",\n";
+    os << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto &r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+           << ", \"items\": " << r.items
+           << ", \"ns_per_iteration\": " << r.ns_per_iteration
+           << ", \"ns_per_item\": " << r.ns_per_item() << "}"
+           << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+void WriteCsv(std::ostream &os, const std::vector<Result> &results)
+{
+    os << "name,iterations,items,ns_per_iteration,ns_per_item\n";
+    for (auto &r : results)
+    {
+        os << r.name << "," << r.iterations << "," << r.items << "," << r.ns_per_iteration << "," << r.ns_per_item() << "\n";
+    }
+}
+
+struct Random
+{
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> dist{-1, 1};
+
+    float operator()()
+    {
+        return dist(rng);
+    }
+
+    falg::float3 float3()
+    {
+        return {(*this)(), (*this)(), (*this)()};
+    }
+
+    falg::float4 rotation()
+    {
+        return falg::Normalize(falg::float4{(*this)(), (*this)(), (*this)(), (*this)()});
+    }
+
+    falg::float16 matrix()
+    {
+        return falg::TRS(float3(), rotation(), {1, 1, 1}).RowMatrix();
+    }
+};
+
+using namespace wgut::gizmo;
+
+const falg::float2 arrow_points[] = {{0.25f, 0}, {0.25f, 0.05f}, {1, 0.05f}, {1, 0.10f}, {1.2f, 0}};
+
+void BenchFalg(Runner &runner, Random &random)
+{
+    const size_t N = 1024;
+    std::vector<falg::float16> matrices(N);
+    for (auto &m : matrices)
+    {
+        m = random.matrix();
+    }
+
+    runner.Run("falg/RowMatrixMul", N, [&]() {
+        auto m = falg::IdentityMatrix();
+        for (auto &r : matrices)
+        {
+            m = falg::RowMatrixMul(m, r);
+        }
+        do_not_optimize(m);
+    });
+
+    runner.Run("falg/RowMatrixMulScalar", N, [&]() {
+        auto m = falg::IdentityMatrix();
+        for (auto &r : matrices)
+        {
+            m = falg::RowMatrixMulScalar(m, r);
+        }
+        do_not_optimize(m);
+    });
+
+    std::vector<falg::float3> points(N);
+    for (auto &p : points)
+    {
+        p = random.float3();
+    }
+    std::vector<falg::float3> dst(N);
+    auto q = random.rotation();
+
+    runner.Run("falg/QuaternionRotateFloat3", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            dst[i] = falg::QuaternionRotateFloat3(q, points[i]);
+        }
+        do_not_optimize(dst);
+    });
+
+    // the nested form QuaternionRotateFloat3 used before LinearCombination
+    runner.Run("falg/QuaternionRotateFloat3/nested", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto &v = points[i];
+            dst[i] = falg::Add(falg::MulScalar(falg::QuaternionXDir(q), v[0]),
+                               falg::Add(falg::MulScalar(falg::QuaternionYDir(q), v[1]), falg::MulScalar(falg::QuaternionZDir(q), v[2])));
+        }
+        do_not_optimize(dst);
+    });
+
+    // blend of 3 matrices
+    std::vector<falg::float16> blended(N);
+    runner.Run("falg/LinearCombination", N, [&]() {
+        for (size_t i = 0; i + 2 < N; ++i)
+        {
+            blended[i] = falg::LinearCombination(matrices[i], 0.5f, matrices[i + 1], 0.25f, matrices[i + 2], 0.25f);
+        }
+        do_not_optimize(blended);
+    });
+
+    runner.Run("falg/LinearCombination/nested", N, [&]() {
+        for (size_t i = 0; i + 2 < N; ++i)
+        {
+            blended[i] = falg::Add(falg::MulScalar(matrices[i], 0.5f),
+                                   falg::Add(falg::MulScalar(matrices[i + 1], 0.25f), falg::MulScalar(matrices[i + 2], 0.25f)));
+        }
+        do_not_optimize(blended);
+    });
+
+    // scene import / export
+    std::vector<falg::TRS> nodes(N);
+    for (auto &node : nodes)
+    {
+        node = falg::TRS(random.float3(), random.rotation(), {1 + random() * 0.5f, 1 + random() * 0.5f, 1 + random() * 0.5f});
+    }
+    std::vector<falg::float16> composed(N);
+    runner.Run("falg/ComposeTRS", N, [&]() {
+        falg::ComposeTRS(nodes, composed);
+        do_not_optimize(composed);
+    });
+
+    // the 4x4 multiply TRS::RowMatrix used before
+    runner.Run("falg/ComposeTRS/multiply", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            composed[i] = falg::ScaleMatrix(nodes[i].scale) * falg::Transform{nodes[i].translation, nodes[i].rotation}.RowMatrix();
+        }
+        do_not_optimize(composed);
+    });
+
+    std::vector<falg::TRS> decomposed(N);
+    runner.Run("falg/Decompose", N, [&]() {
+        falg::Decompose(composed, decomposed);
+        do_not_optimize(decomposed);
+    });
+
+    runner.Run("falg/RowMatrixDecompose", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            decomposed[i] = falg::RowMatrixDecompose(composed[i]);
+        }
+        do_not_optimize(decomposed);
+    });
+
+    // one pick ray against the bounds of many meshes
+    std::vector<float> box[6];
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto c = random.float3();
+        auto e = random() * 0.1f + 0.1f;
+        for (int k = 0; k < 3; ++k)
+        {
+            box[k].push_back(c[k] - e);
+            box[3 + k].push_back(c[k] + e);
+        }
+    }
+    falg::aabb_span boxes{box[0], box[1], box[2], box[3], box[4], box[5]};
+    falg::Ray pick{random.float3(), falg::Normalize(random.float3())};
+    std::vector<float> distances(N);
+    runner.Run("falg/IntersectAABBs", N, [&]() {
+        falg::IntersectAABBs(pick, boxes, std::span(distances));
+        do_not_optimize(distances);
+    });
+
+    runner.Run("falg/IntersectAABBs/scalar", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            distances[i] = pick >> falg::AABB{{box[0][i], box[1][i], box[2][i]}, {box[3][i], box[4][i], box[5][i]}};
+        }
+        do_not_optimize(distances);
+    });
+
+    falg::Transform t{random.float3(), q};
+    runner.Run("falg/Transform::ApplyPosition", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            dst[i] = t.ApplyPosition(points[i]);
+        }
+        do_not_optimize(dst);
+    });
+
+    runner.Run("falg/Transform::ApplyPositions", N, [&]() {
+        t.ApplyPositions(points, dst);
+        do_not_optimize(dst);
+    });
+}
+
+template <typename T>
+bool SameBits(const std::vector<T> &l, const std::vector<T> &r)
+{
+    return l.size() == r.size() && std::memcmp(l.data(), r.data(), sizeof(T) * l.size()) == 0;
+}
+
+// force each isa, compare with the Scalar table and time it
+bool BenchDispatch(Runner &runner, Random &random)
+{
+    using namespace falg::dispatch;
+    const size_t N = 1024 + 3; // not a multiple of the vector width
+
+    std::vector<float> x(N), y(N), z(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        x[i] = random();
+        y[i] = random();
+        z[i] = random();
+    }
+    auto basis = falg::TRS(random.float3(), random.rotation(), {2, 2, 2}).Basis();
+    std::vector<float> dx(N), dy(N), dz(N);
+    falg::xyz_span<const float> src{x, y, z};
+    falg::xyz_span<float> dst{dx, dy, dz};
+
+    std::vector<falg::float16> l(N), r(N), m(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        l[i] = random.matrix();
+        r[i] = random.matrix();
+    }
+
+    auto lathed = geometry_mesh::make_lathed_geometry({1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 64, arrow_points, (uint32_t)std::size(arrow_points));
+    lathed.build_packets();
+    std::vector<falg::Ray> rays;
+    for (int i = 0; i < 256; ++i)
+    {
+        rays.push_back({{random() * 1.5f, random() * 0.2f, 2}, falg::Normalize(falg::float3{random() * 0.1f, random() * 0.1f, -1})});
+    }
+    std::vector<falg::RayHit> hits(rays.size());
+
+    // vertex attribute range and some specials
+    std::vector<float> floats(N * 4);
+    for (auto &f : floats)
+    {
+        f = random() * 1000;
+    }
+    floats[0] = 65520.0f;
+    floats[1] = 1e-7f;
+    floats[2] = -std::numeric_limits<float>::infinity();
+    floats[3] = std::numeric_limits<float>::quiet_NaN();
+    std::vector<uint16_t> halves(floats.size());
+    std::vector<float> restored(floats.size());
+
+    auto run = [&]() {
+        auto &k = ActiveKernels();
+        k.apply_positions(basis, src, dst);
+        k.row_matrix_mul(l, r, m);
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            hits[i] = k.intersect_triangle_packets(rays[i], *lathed.packets);
+        }
+        k.float_to_half(floats, halves);
+        k.half_to_float(halves, restored);
+    };
+
+    ForceIsa(Isa::Scalar);
+    run();
+    auto ex = dx, ey = dy, ez = dz;
+    auto em = m;
+    auto ehits = hits;
+    auto ehalves = halves;
+    auto erestored = restored;
+
+    bool ok = true;
+    for (auto isa : {Isa::Scalar, Isa::SSE2, Isa::AVX, Isa::AVX512})
+    {
+        if (!ForceIsa(isa))
+        {
+            continue;
+        }
+        std::string name = IsaName(isa);
+
+        run();
+        if (!SameBits(dx, ex) || !SameBits(dy, ey) || !SameBits(dz, ez))
+        {
+            std::cerr << "dispatch/apply_positions/" << name << ": differs from Scalar" << std::endl;
+            ok = false;
+        }
+        if (!SameBits(m, em))
+        {
+            std::cerr << "dispatch/row_matrix_mul/" << name << ": differs from Scalar" << std::endl;
+            ok = false;
+        }
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            if (hits[i].triangle != ehits[i].triangle || std::memcmp(&hits[i].t, &ehits[i].t, sizeof(float)) != 0)
+            {
+                std::cerr << "dispatch/intersect_triangle_packets/" << name << ": ray " << i << " differs from Scalar" << std::endl;
+                ok = false;
+                break;
+            }
+        }
+
+        if (!SameBits(halves, ehalves))
+        {
+            std::cerr << "dispatch/float_to_half/" << name << ": differs from Scalar" << std::endl;
+            ok = false;
+        }
+        if (!SameBits(restored, erestored))
+        {
+            std::cerr << "dispatch/half_to_float/" << name << ": differs from Scalar" << std::endl;
+            ok = false;
+        }
+
+        auto &k = ActiveKernels();
+        runner.Run("dispatch/apply_positions/" + name, N, [&]() {
+            k.apply_positions(basis, src, dst);
+            do_not_optimize(dx);
+        });
+        runner.Run("dispatch/row_matrix_mul/" + name, N, [&]() {
+            k.row_matrix_mul(l, r, m);
+            do_not_optimize(m);
+        });
+        runner.Run("dispatch/intersect_triangle_packets/" + name, rays.size(), [&]() {
+            for (auto &ray : rays)
+            {
+                auto hit = k.intersect_triangle_packets(ray, *lathed.packets);
+                do_not_optimize(hit);
+            }
+        });
+        runner.Run("dispatch/float_to_half/" + name, floats.size(), [&]() {
+            k.float_to_half(floats, halves);
+            do_not_optimize(halves);
+        });
+        runner.Run("dispatch/half_to_float/" + name, halves.size(), [&]() {
+            k.half_to_float(halves, restored);
+            do_not_optimize(restored);
+        });
+    }
+    ResetIsa();
+    return ok;
+}
+
+// the SIMD paths of the falg core against the scalar order of operations
+template <size_t N>
+bool CheckVectorOps(Random &random, const char *name)
+{
+    using V = std::array<float, N>;
+    bool ok = true;
+    auto check = [&](const char *op, const auto &value, const auto &expected) {
+        if (std::memcmp(&value, &expected, sizeof(value)) != 0)
+        {
+            std::cerr << "falg/" << op << "/" << name << ": differs from Scalar" << std::endl;
+            ok = false;
+        }
+    };
+    for (int n = 0; n < 1000 && ok; ++n)
+    {
+        V l, r;
+        for (size_t i = 0; i < N; ++i)
+        {
+            l[i] = random() * 100;
+            r[i] = random() * 100;
+        }
+        auto s = random() * 10;
+
+        V add, sub, mul, scaled;
+        float dot = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            add[i] = l[i] + r[i];
+            sub[i] = l[i] - r[i];
+            mul[i] = l[i] * r[i];
+            scaled[i] = l[i] * s;
+            dot += l[i] * r[i];
+        }
+        float dotL = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            dotL += l[i] * l[i];
+        }
+        auto inv = 1.0f / std::sqrt(dotL);
+        V normalized;
+        for (size_t i = 0; i < N; ++i)
+        {
+            normalized[i] = l[i] * inv;
+        }
+
+        check("Add", falg::Add(l, r), add);
+        check("Sub", falg::Sub(l, r), sub);
+        check("EachMul", falg::EachMul(l, r), mul);
+        check("MulScalar", falg::MulScalar(l, s), scaled);
+        check("Dot", falg::Dot(l, r), dot);
+        check("Normalize", falg::Normalize(l), normalized);
+    }
+    return ok;
+}
+
+bool CheckFalg(Random &random)
+{
+    bool ok = CheckVectorOps<3>(random, "float3");
+    ok = CheckVectorOps<4>(random, "float4") && ok;
+    ok = CheckVectorOps<16>(random, "float16") && ok;
+
+    auto check = [&](const char *op, const falg::float16 &value, const falg::float16 &expected) {
+        if (std::memcmp(&value, &expected, sizeof(value)) != 0)
+        {
+            std::cerr << "falg/" << op << ": differs from RowMatrixMulScalar" << std::endl;
+            ok = false;
+            return false;
+        }
+        return true;
+    };
+    for (int n = 0; n < 1000; ++n)
+    {
+        falg::float16 l, r;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            l[i] = random() * 100;
+            r[i] = random() * 100;
+        }
+        auto expected = falg::RowMatrixMulScalar(l, r);
+        if (!check("RowMatrixMul", falg::RowMatrixMul(l, r), expected))
+        {
+            break;
+        }
+#if defined(FALG_SSE2)
+        if (!check("RowMatrixMulSSE2", falg::RowMatrixMulSSE2(l, r), expected))
+        {
+            break;
+        }
+        if (falg::dispatch::IsSupported(falg::dispatch::Isa::AVX) && !check("RowMatrixMulAVX", falg::RowMatrixMulAVX(l, r), expected))
+        {
+            break;
+        }
+#endif
+    }
+    return ok;
+}
+
+// axis aligned rays with the origin on the face and edge planes of boxes, flat ones included.
+// 0 * inf in the slab test is NaN there
+bool CheckRaySlab()
+{
+    const falg::AABB boxes[] = {
+        {{0, 0, 0}, {1, 1, 1}},
+        {{0, 0, 0}, {1, 1, 0}},
+        {{0, 0, 0}, {0, 1, 1}},
+        {{0, 0, 0}, {1, 0, 1}},
+        {{0, 0, 0}, {1, 0, 0}},
+    };
+    std::vector<float> bounds[6];
+    for (auto &box : boxes)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            bounds[k].push_back(box.min[k]);
+            bounds[k + 3].push_back(box.max[k]);
+        }
+    }
+    falg::aabb_span span{bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]};
+    const float planes[] = {-0.5f, 0, 0.5f, 1, 1.5f};
+    const auto miss = std::numeric_limits<float>::infinity();
+
+    bool ok = true;
+    std::vector<float> t(std::size(boxes));
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        auto u = (axis + 1) % 3;
+        auto v = (axis + 2) % 3;
+        for (auto sign : {1.0f, -1.0f})
+        {
+            // +0 and -0 in the other components. the inverse is +inf and -inf
+            for (auto zero : {0.0f, -0.0f})
+            {
+                for (auto pu : planes)
+                {
+                    for (auto pv : planes)
+                    {
+                        falg::float3 origin, direction{zero, zero, zero};
+                        origin[axis] = sign > 0 ? -2.0f : 3.0f;
+                        origin[u] = pu;
+                        origin[v] = pv;
+                        direction[axis] = sign;
+                        falg::Ray ray{origin, direction};
+                        falg::IntersectAABBs(ray, span, std::span(t));
+                        for (size_t i = 0; i < std::size(boxes); ++i)
+                        {
+                            auto &box = boxes[i];
+                            auto inside = box.min[u] <= pu && pu <= box.max[u] && box.min[v] <= pv && pv <= box.max[v];
+                            auto expected = !inside ? miss : sign > 0 ? box.min[axis] - ray.origin[axis] : ray.origin[axis] - box.max[axis];
+                            if ((ray >> box) != expected || t[i] != expected)
+                            {
+                                std::cerr << "falg/ray_slab: box " << i << " axis " << axis << " sign " << sign << " at (" << pu << ", " << pv
+                                          << ") is " << (ray >> box) << " and " << t[i] << ", not " << expected << std::endl;
+                                ok = false;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+void BenchScene(Runner &runner, Random &random)
+{
+    const size_t N = 4096;
+    wgut::scene::TransformStore store;
+    store.Reserve(N);
+    std::vector<falg::TRS> nodes(N);
+    for (auto &node : nodes)
+    {
+        node = falg::TRS(random.float3(), random.rotation(), {1 + random() * 0.5f, 1 + random() * 0.5f, 1 + random() * 0.5f});
+        store.Create(node);
+    }
+
+    runner.Run("scene/TransformStore::UpdateMatrices", N, [&]() {
+        auto matrices = store.UpdateMatrices();
+        do_not_optimize(matrices);
+    });
+
+    // same work from an array of TRS
+    std::vector<falg::float16> composed(N);
+    runner.Run("scene/TransformStore::UpdateMatrices/aos", N, [&]() {
+        falg::ComposeTRS(nodes, composed);
+        do_not_optimize(composed);
+    });
+
+    // swap-remove the first one and add it back
+    runner.Run("scene/TransformStore::Destroy+Create", 1, [&]() {
+        auto h = store.HandleAt(0);
+        auto trs = store.Get(0);
+        store.Destroy(h);
+        store.Create(trs);
+    });
+
+    // 8-ary tree of 200k nodes
+    const uint32_t NODES = 200000;
+    wgut::scene::SceneGraph graph;
+    graph.Reserve(NODES);
+    for (uint32_t i = 0; i < NODES; ++i)
+    {
+        graph.AddNode(i == 0 ? wgut::scene::SceneGraph::NO_PARENT : (i - 1) / 8, nodes[i % N]);
+    }
+
+    runner.Run("scene/SceneGraph::UpdateAll", NODES, [&]() {
+        graph.UpdateAll();
+        do_not_optimize(graph);
+    });
+
+    runner.Run("scene/SceneGraph::UpdateParallel", NODES, [&]() {
+        graph.MarkDirty(0);
+        auto count = graph.UpdateParallel();
+        do_not_optimize(count);
+    });
+
+    // a gizmo moves one node at depth 3. 585 nodes in the subtree
+    auto moved = graph.Local(100);
+    runner.Run("scene/SceneGraph::Update/subtree", 585, [&]() {
+        moved.translation[0] += 0.01f;
+        graph.SetLocal(100, moved);
+        auto count = graph.Update();
+        do_not_optimize(count);
+    });
+}
+
+// flat objects on the cell boundaries and axis aligned rays along them, from outside and from the faces.
+// the tree must find the same objects as testing every box
+bool CheckOctree()
+{
+    wgut::scene::LooseOctree tree({0, 0, 0}, 8);
+    std::vector<falg::AABB> boxes;
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            auto x = static_cast<float>(i);
+            auto y = static_cast<float>(j);
+            boxes.push_back({{x, 2, y}, {x + 1, 2, y + 1}});
+            boxes.push_back({{4, x, y}, {4, x + 1, y + 1}});
+            boxes.push_back({{x, y, 4}, {x + 1, y + 1, 4}});
+        }
+    }
+    for (auto &box : boxes)
+    {
+        tree.Insert(box);
+    }
+
+    const float planes[] = {0, 0.5f, 2, 2.5f, 4, 8};
+    bool ok = true;
+    std::vector<uint32_t> found(boxes.size());
+    std::vector<uint32_t> expected;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (auto sign : {1.0f, -1.0f})
+        {
+            for (auto start : {sign > 0 ? -1.0f : 9.0f, 2.0f, 4.0f})
+            {
+                for (auto a : planes)
+                {
+                    for (auto b : planes)
+                    {
+                        falg::float3 origin, direction{0, 0, 0};
+                        origin[axis] = start;
+                        origin[(axis + 1) % 3] = a;
+                        origin[(axis + 2) % 3] = b;
+                        direction[axis] = sign;
+                        falg::Ray ray{origin, direction};
+
+                        expected.clear();
+                        for (uint32_t i = 0; i < boxes.size(); ++i)
+                        {
+                            if (!std::isinf(ray >> boxes[i]))
+                            {
+                                expected.push_back(i);
+                            }
+                        }
+                        auto count = tree.Query(ray, found);
+                        std::sort(found.begin(), found.begin() + count);
+                        if (!std::equal(expected.begin(), expected.end(), found.begin(), found.begin() + count))
+                        {
+                            std::cerr << "scene/LooseOctree::Query/ray: (" << origin[0] << ", " << origin[1] << ", " << origin[2] << ") axis "
+                                      << axis << " sign " << sign << " found " << count << ", not " << expected.size() << std::endl;
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+void BenchOctree(Runner &runner, Random &random)
+{
+    const size_t N = 20000;
+    wgut::scene::LooseOctree tree({-500, -500, -500}, 1000);
+    std::vector<falg::AABB> boxes;
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto c = falg::float3{random() * 500, random() * 100, random() * 500};
+        auto e = 0.5f + (random() + 1) * 2;
+        boxes.push_back({falg::Sub(c, {e, e, e}), falg::Add(c, {e, e, e})});
+        ids.push_back(tree.Insert(boxes.back()));
+    }
+
+    // every object moves a little
+    runner.Run("scene/LooseOctree::Update", N, [&]() {
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto d = falg::float3{random(), random() * 0.2f, random()};
+            boxes[i] = {falg::Add(boxes[i].min, d), falg::Add(boxes[i].max, d)};
+            tree.Update(ids[i], boxes[i]);
+        }
+    });
+
+    std::array<float, 16> projection;
+    falg::PerspectiveRHDX(projection.data(), 1.0f, 1.0f, 0.1f, 300.0f);
+    auto frustum = falg::Frustum::FromViewProjection(falg::IdentityMatrix(), projection, falg::ClipDepth::ZeroToOne);
+    std::vector<uint32_t> visible(N);
+    runner.Run("scene/LooseOctree::Query/frustum", N, [&]() {
+        auto count = tree.Query(frustum, visible);
+        do_not_optimize(count);
+    });
+
+    std::vector<float> bounds[6];
+    for (auto &b : boxes)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            bounds[k].push_back(b.min[k]);
+            bounds[3 + k].push_back(b.max[k]);
+        }
+    }
+    runner.Run("scene/LooseOctree::Query/frustum/linear", N, [&]() {
+        auto count = falg::CullAABBs(frustum, {bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]}, visible);
+        do_not_optimize(count);
+    });
+
+    falg::Ray ray{{0, 50, 0}, falg::Normalize(falg::float3{1, -0.1f, 0.5f})};
+    runner.Run("scene/LooseOctree::Query/ray", N, [&]() {
+        auto count = tree.Query(ray, visible);
+        do_not_optimize(count);
+    });
+}
+
+void BenchMesh(Runner &runner, Random &random)
+{
+    runner.Run("geometry_mesh/make_lathed_geometry", 1, [&]() {
+        auto mesh = geometry_mesh::make_lathed_geometry({1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 16, arrow_points, (uint32_t)std::size(arrow_points));
+        do_not_optimize(mesh);
+    });
+
+    auto lathed = geometry_mesh::make_lathed_geometry({1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 64, arrow_points, (uint32_t)std::size(arrow_points));
+    runner.Run("geometry_mesh/compute_normals", lathed.vertices.size(), [&]() {
+        auto mesh = lathed;
+        mesh.compute_normals();
+        do_not_optimize(mesh);
+    });
+
+    // rays around the arrow
+    std::vector<falg::Ray> rays;
+    for (int i = 0; i < 256; ++i)
+    {
+        rays.push_back({{random() * 1.5f, random() * 0.2f, 2}, falg::Normalize(falg::float3{random() * 0.1f, random() * 0.1f, -1})});
+    }
+    runner.Run("geometry_mesh/raycast", rays.size(), [&]() {
+        for (auto &ray : rays)
+        {
+            auto t = ray >> lathed;
+            do_not_optimize(t);
+        }
+    });
+
+    auto packed = lathed;
+    packed.build_packets();
+    runner.Run("geometry_mesh/raycast_packets", rays.size(), [&]() {
+        for (auto &ray : rays)
+        {
+            auto t = ray >> packed;
+            do_not_optimize(t);
+        }
+    });
+}
+
+// bumpy grid in [-1, 1]. 2 * size * size triangles. flat with height 0
+geometry_mesh make_grid_mesh(int size, float height = 0.1f)
+{
+    geometry_mesh mesh;
+    for (int y = 0; y <= size; ++y)
+    {
+        for (int x = 0; x <= size; ++x)
+        {
+            auto fx = x * 2.0f / size - 1;
+            auto fy = y * 2.0f / size - 1;
+            mesh.vertices.push_back({{fx, height * std::sin(fx * 20) * std::cos(fy * 15), fy}, {0, 1, 0}});
+        }
+    }
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            uint32_t i = y * (size + 1) + x;
+            mesh.triangles.insert(mesh.triangles.end(), {i, i + 1, i + size + 2, i, i + size + 2, i + size + 1});
+        }
+    }
+    return mesh;
+}
+
+// axis aligned rays on a flat grid, through vertices, edges and cells and along the plane.
+// the bvh and the packets must match the linear scan
+bool CheckMeshBvh()
+{
+    auto linear = make_grid_mesh(4, 0);
+    auto bvh = linear;
+    bvh.build_bvh();
+    auto packed = linear;
+    packed.build_packets();
+
+    const float planes[] = {-1.5f, -1, -0.75f, -0.5f, 0, 0.25f, 0.5f, 1};
+    std::vector<falg::Ray> rays;
+    for (auto a : planes)
+    {
+        for (auto b : planes)
+        {
+            rays.push_back({{a, 1, b}, {0, -1, 0}});
+            rays.push_back({{a, -1, b}, {0, 1, 0}});
+        }
+        rays.push_back({{-2, 0, a}, {1, 0, 0}});
+        rays.push_back({{a, 0, 2}, {0, 0, -1}});
+    }
+
+    bool ok = true;
+    for (auto &ray : rays)
+    {
+        auto expected = ray >> linear;
+        auto fromBvh = ray >> bvh;
+        auto fromPackets = ray >> packed;
+        if (fromBvh != expected || fromPackets != expected)
+        {
+            std::cerr << "geometry_mesh/raycast_bvh: (" << ray.origin[0] << ", " << ray.origin[1] << ", " << ray.origin[2] << ") is "
+                      << fromBvh << " and " << fromPackets << " with packets, not " << expected << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// flat instances side by side, boxes touching, picked with axis aligned rays on the shared edges.
+// the scene must find the nearest hit of the placed meshes
+bool CheckSceneBvh()
+{
+    auto tile = make_grid_mesh(2, 0);
+    tile.build_bvh();
+    wgut::scene::SceneBvh scene;
+    std::vector<geometry_mesh> placed;
+    for (int x = 0; x < 4; ++x)
+    {
+        for (int z = 0; z < 4; ++z)
+        {
+            falg::Transform t{{x * 2.0f, 0, z * 2.0f}, {0, 0, 0, 1}};
+            scene.AddInstance(tile.bvh, t);
+            placed.push_back(tile.transformed(t));
+        }
+    }
+    scene.Update();
+
+    std::vector<falg::Ray> rays;
+    for (int a = -2; a <= 16; ++a)
+    {
+        for (int b = -2; b <= 16; ++b)
+        {
+            rays.push_back({{a * 0.5f, 1, b * 0.5f}, {0, -1, 0}});
+        }
+        rays.push_back({{-2, 0, a * 0.5f}, {1, 0, 0}});
+    }
+
+    bool ok = true;
+    for (auto &ray : rays)
+    {
+        auto expected = std::numeric_limits<float>::infinity();
+        for (auto &mesh : placed)
+        {
+            expected = std::min(expected, ray >> mesh);
+        }
+        auto hit = scene.Intersect(ray);
+        if (hit.t != expected)
+        {
+            std::cerr << "scene/SceneBvh::Intersect: (" << ray.origin[0] << ", " << ray.origin[1] << ", " << ray.origin[2] << ") is " << hit.t
+                      << ", not " << expected << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void BenchBvh(Runner &runner, Random &random)
+{
+    auto grid = make_grid_mesh(200);
+    auto triangles = grid.triangles.size() / 3;
+    runner.Run("geometry_mesh/build_bvh", triangles, [&]() {
+        grid.build_bvh();
+    });
+
+    runner.Run("geometry_mesh/refit_bvh", triangles, [&]() {
+        grid.refit_bvh();
+    });
+
+    // hover rays from above
+    std::vector<falg::Ray> rays;
+    for (int i = 0; i < 256; ++i)
+    {
+        rays.push_back({{random(), 1, random()}, falg::Normalize(falg::float3{random() * 0.5f, -1, random() * 0.5f})});
+    }
+    runner.Run("geometry_mesh/raycast_bvh", rays.size(), [&]() {
+        for (auto &ray : rays)
+        {
+            auto t = ray >> grid;
+            do_not_optimize(t);
+        }
+    });
+
+    // 20k instances of a small mesh
+    auto tile = make_grid_mesh(32);
+    tile.build_bvh();
+    wgut::scene::SceneBvh scene;
+    std::vector<falg::Transform> instances;
+    for (int i = 0; i < 20000; ++i)
+    {
+        instances.push_back({{random() * 200, random() * 20, random() * 200}, random.rotation()});
+        scene.AddInstance(tile.bvh, instances.back());
+    }
+    runner.Run("scene/SceneBvh::Update/rebuild", instances.size(), [&]() {
+        scene.RemoveInstance(0);
+        scene.AddInstance(tile.bvh, instances[0]);
+        scene.Update();
+    });
+
+    // 10% of the instances move every frame
+    size_t frame = 0;
+    runner.Run("scene/SceneBvh::Update/refit", instances.size(), [&]() {
+        for (size_t i = frame++ % 10; i < instances.size(); i += 10)
+        {
+            auto &t = instances[i];
+            t.translation[0] += random() * 0.5f;
+            scene.SetTransform(static_cast<uint32_t>(i), t);
+        }
+        scene.Update();
+    });
+
+    std::vector<falg::Ray> picks;
+    for (int i = 0; i < 256; ++i)
+    {
+        picks.push_back({{random() * 200, 50, random() * 200}, falg::Normalize(falg::float3{random() * 0.3f, -1, random() * 0.3f})});
+    }
+    runner.Run("scene/SceneBvh::Intersect", picks.size(), [&]() {
+        for (auto &ray : picks)
+        {
+            auto hit = scene.Intersect(ray);
+            do_not_optimize(hit);
+        }
+    });
+
+    grid.bvh.reset();
+    grid.build_packets();
+    runner.Run("geometry_mesh/raycast_bvh/packets", rays.size(), [&]() {
+        for (auto &ray : rays)
+        {
+            auto t = ray >> grid;
+            do_not_optimize(t);
+        }
+    });
+}
+
+void BenchOcclusion(Runner &runner, Random &random)
+{
+    wgut::CameraState camera;
+    falg::PerspectiveRHDX(camera.projection.data(), camera.fovYRadians, 16.0f / 9.0f, 0.1f, 300.0f);
+    camera.view = falg::IdentityMatrix();
+
+    // walls in front of the camera
+    std::vector<geometry_mesh> walls;
+    size_t triangles = 0;
+    for (int i = 0; i < 64; ++i)
+    {
+        auto c = falg::float3{random() * 40, random() * 10, -20 + random() * 10};
+        walls.push_back(geometry_mesh::make_box_geometry(falg::Sub(c, {4, 3, 0.2f}), falg::Add(c, {4, 3, 0.2f})));
+        triangles += walls.back().triangles.size() / 3;
+    }
+    // and a dense one
+    walls.push_back(make_grid_mesh(64).transformed({{0, 0, -40}, falg::QuaternionAxisAngle({1, 0, 0}, 1.5f)}));
+    triangles += walls.back().triangles.size() / 3;
+
+    const size_t N = 20000;
+    std::vector<float> bounds[6];
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto c = falg::float3{random() * 60, random() * 20, -45 + random() * 20};
+        auto e = 0.2f + (random() + 1);
+        for (int k = 0; k < 3; ++k)
+        {
+            bounds[k].push_back(c[k] - e);
+            bounds[3 + k].push_back(c[k] + e);
+        }
+    }
+    falg::aabb_span boxes{bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]};
+    std::vector<uint32_t> visible(N);
+
+    wgut::scene::OcclusionCuller culler(256, 128);
+    auto rasterize = [&](uint32_t threadCount) {
+        culler.Begin(camera);
+        for (auto &wall : walls)
+        {
+            culler.AddOccluder(std::span<const geometry_vertex>(wall.vertices), std::span<const uint32_t>(wall.triangles), &geometry_vertex::position);
+        }
+        culler.Rasterize(threadCount);
+    };
+    runner.Run("scene/OcclusionCuller::Rasterize", triangles, [&]() {
+        rasterize(1);
+    });
+    runner.Run("scene/OcclusionCuller::Rasterize/threads", triangles, [&]() {
+        rasterize(std::thread::hardware_concurrency());
+    });
+    runner.Run("scene/OcclusionCuller::Visible", N, [&]() {
+        auto count = culler.Visible(boxes, visible);
+        do_not_optimize(count);
+    });
+}
+
+void BenchLod(Runner &runner, Random &random)
+{
+    const size_t N = 100000;
+    wgut::scene::LodSelector lod;
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        wgut::scene::LodLevel levels[]{{0, 0}, {1, 0.01f}, {2, 0.04f}, {3, 0.16f}};
+        auto c = falg::float3{random() * 500, random() * 50, random() * 500};
+        lod.AddObject(levels, falg::Sphere{c, 1 + random()});
+    }
+
+    wgut::CameraState camera;
+    camera.viewportHeight = 1080;
+    camera.position = {0, 10, 0};
+    runner.Run("scene/LodSelector::Select", N, [&]() {
+        // a little motion for the hysteresis
+        camera.position[0] += 0.1f;
+        lod.Select(camera);
+        do_not_optimize(lod.LevelCount());
+    });
+}
+
+void BenchKdTree(Runner &runner, Random &random)
+{
+    auto grid = make_grid_mesh(1000);
+    auto vertices = std::span<const geometry_vertex>(grid.vertices);
+    wgut::scene::KdTree tree;
+    runner.Run("scene/KdTree::Build", vertices.size(), [&]() {
+        tree.Build(vertices, &geometry_vertex::position);
+    });
+
+    const size_t Q = 1000;
+    std::vector<falg::float3> queries;
+    for (size_t i = 0; i < Q; ++i)
+    {
+        // near the surface like a drag point
+        auto &v = vertices[static_cast<size_t>((random() + 1) * 0.5f * (vertices.size() - 1))].position;
+        queries.push_back({v[0] + random() * 0.01f, v[1] + random() * 0.01f, v[2] + random() * 0.01f});
+    }
+    runner.Run("scene/KdTree::Nearest", Q, [&]() {
+        for (auto &q : queries)
+        {
+            do_not_optimize(tree.Nearest(q));
+        }
+    });
+    wgut::scene::KdNeighbor neighbors[8];
+    runner.Run("scene/KdTree::Nearest/8", Q, [&]() {
+        for (auto &q : queries)
+        {
+            do_not_optimize(tree.Nearest(q, neighbors));
+        }
+    });
+    uint32_t found[256];
+    runner.Run("scene/KdTree::Radius", Q, [&]() {
+        for (auto &q : queries)
+        {
+            do_not_optimize(tree.Radius(q, 0.01f, found));
+        }
+    });
+    runner.Run("scene/KdTree::Nearest/brute", 1, [&]() {
+        auto &q = queries[0];
+        float best = std::numeric_limits<float>::infinity();
+        for (auto &v : vertices)
+        {
+            auto d = falg::Sub(v.position, q);
+            best = std::min(best, falg::Dot(d, d));
+        }
+        do_not_optimize(best);
+    });
+}
+
+void BenchWeld(Runner &runner)
+{
+    // a vertex per corner like an imported mesh
+    auto grid = make_grid_mesh(200);
+    geometry_mesh split;
+    for (auto i : grid.triangles)
+    {
+        split.triangles.push_back(static_cast<uint32_t>(split.vertices.size()));
+        split.vertices.push_back(grid.vertices[i]);
+    }
+    std::vector<uint32_t> remap(split.vertices.size());
+    runner.Run("mesh/WeldVertices", split.vertices.size(), [&]() {
+        auto count = wgut::mesh::WeldVertices(std::span<const geometry_vertex>(split.vertices), &geometry_vertex::position, remap);
+        do_not_optimize(count);
+    });
+    runner.Run("geometry_mesh/compute_normals/split", split.vertices.size(), [&]() {
+        auto mesh = split;
+        mesh.compute_normals();
+        do_not_optimize(mesh);
+    });
+}
+
+// triangles of the grid in random order
+geometry_mesh make_shuffled_grid_mesh(int size, Random &random)
+{
+    auto mesh = make_grid_mesh(size);
+    auto triangleCount = mesh.triangles.size() / 3;
+    for (size_t i = triangleCount - 1; i > 0; --i)
+    {
+        auto j = static_cast<size_t>((random() + 1) * 0.5f * i);
+        for (int k = 0; k < 3; ++k)
+        {
+            std::swap(mesh.triangles[i * 3 + k], mesh.triangles[j * 3 + k]);
+        }
+    }
+    return mesh;
+}
+
+void BenchVertexCache(Runner &runner, Random &random)
+{
+    auto mesh = make_shuffled_grid_mesh(300, random);
+    auto triangles = mesh.triangles.size() / 3;
+    wgut::mesh::VertexCacheResult result;
+    runner.Run("mesh/OptimizeVertexCache", triangles, [&]() {
+        auto optimized = mesh;
+        result = optimized.optimize_vertex_cache();
+        do_not_optimize(optimized);
+    });
+    if (result.after.acmr > 0)
+    {
+        std::cerr << "mesh/OptimizeVertexCache: ACMR " << result.before.acmr << " -> " << result.after.acmr
+                  << ", ATVR " << result.before.atvr << " -> " << result.after.atvr << std::endl;
+    }
+}
+
+void BenchOverdraw(Runner &runner, Random &random)
+{
+    auto mesh = make_shuffled_grid_mesh(300, random);
+    mesh.optimize_vertex_cache();
+    auto triangles = mesh.triangles.size() / 3;
+    wgut::mesh::OverdrawResult result;
+    runner.Run("mesh/OptimizeOverdraw", triangles, [&]() {
+        auto optimized = mesh;
+        result = optimized.optimize_overdraw();
+        do_not_optimize(optimized);
+    });
+    if (result.clusters > 0)
+    {
+        // the cost on the vertex cache
+        auto optimized = mesh;
+        optimized.optimize_overdraw();
+        auto before = wgut::mesh::AnalyzeVertexCache(std::span<const uint32_t>(mesh.triangles), mesh.vertices.size());
+        auto after = wgut::mesh::AnalyzeVertexCache(std::span<const uint32_t>(optimized.triangles), mesh.vertices.size());
+        std::cerr << "mesh/OptimizeOverdraw: overdraw " << result.before.Overdraw() << " -> " << result.after.Overdraw()
+                  << " in " << result.clusters << " clusters, ACMR " << before.acmr << " -> " << after.acmr << std::endl;
+    }
+}
+
+void BenchVertexFetch(Runner &runner)
+{
+    // the last quarter of the rows removed, their vertices are left unreferenced
+    auto grid = make_grid_mesh(300);
+    grid.triangles.resize(grid.triangles.size() / 4 * 3);
+    grid.optimize_vertex_cache();
+    wgut::mesh::MeshBuilder mesh(sizeof(geometry_vertex), 4);
+    for (auto &v : grid.vertices)
+    {
+        mesh.AppendVertex(v);
+    }
+    for (auto i : grid.triangles)
+    {
+        mesh.AppendIndex(i);
+    }
+
+    auto triangles = grid.triangles.size() / 3;
+    wgut::mesh::VertexFetchResult result;
+    runner.Run("mesh/OptimizeVertexFetch", triangles, [&]() {
+        auto optimized = mesh;
+        result = wgut::mesh::OptimizeVertexFetch(optimized);
+        do_not_optimize(optimized);
+    });
+    if (result.vertexCountBefore > 0)
+    {
+        std::cerr << "mesh/OptimizeVertexFetch: vertices " << result.vertexCountBefore << " -> " << result.vertexCountAfter
+                  << ", " << result.bytesSaved << " bytes saved" << std::endl;
+    }
+}
+
+void BenchMeshlets(Runner &runner)
+{
+    // a sphere of radius 1 in front of the camera
+    std::vector<falg::float2> profile;
+    for (int i = 0; i <= 256; ++i)
+    {
+        auto angle = 3.14159265f * i / 256;
+        profile.push_back({-std::cos(angle), std::sin(angle)});
+    }
+    auto sphere = geometry_mesh::make_lathed_geometry({1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 256, profile.data(), (uint32_t)profile.size());
+    sphere.optimize_vertex_cache();
+    auto triangles = sphere.triangles.size() / 3;
+
+    wgut::mesh::Meshlets meshlets;
+    runner.Run("mesh/Meshlets/Build", triangles, [&]() {
+        meshlets = sphere.build_meshlets();
+    });
+
+    wgut::CameraState camera;
+    falg::PerspectiveRHDX(camera.projection.data(), camera.fovYRadians, 16.0f / 9.0f, 0.1f, 100.0f);
+    camera.view = falg::IdentityMatrix();
+    camera.position = {0, 0, 0};
+    auto world = falg::TranslationMatrix(0.5f, 0, -3);
+    std::vector<uint32_t> indices(meshlets.Indices().size());
+    size_t count = 0;
+    runner.Run("mesh/Meshlets/Cull", meshlets.Size(), [&]() {
+        count = meshlets.Cull(camera, std::span<uint32_t>(indices), world);
+        do_not_optimize(indices);
+    });
+    if (meshlets.Size() > 0)
+    {
+        std::cerr << "mesh/Meshlets: " << meshlets.Size() << " meshlets, " << count / 3 << " of " << triangles << " triangles visible"
+                  << std::endl;
+    }
+}
+
+void BenchGizmo(Runner &runner)
+{
+    GizmoSystem gizmo;
+    falg::float3 t{0, 0, 0};
+    falg::float4 r{0, 0, 0, 1};
+    falg::float3 s{1, 1, 1};
+    int frame = 0;
+    runner.Run("gizmo/frame", 1, [&]() {
+        // camera on +z, ray through the x arrow. press and release every few frames
+        ++frame;
+        gizmo.begin({0, 0, 5}, {0, 0, 0, 1}, {0, 0, 5}, falg::Normalize(falg::float3{0.15f, 0.01f, -1}), (frame / 4) % 2 == 1);
+        handle::translation(gizmo, 1, false, nullptr, t, r);
+        handle::rotation(gizmo, 2, false, nullptr, t, r);
+        handle::scale(gizmo, 3, false, t, r, s);
+        auto buffer = gizmo.end();
+        do_not_optimize(buffer);
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool csv = false;
+    std::string_view filter;
+    double minSeconds = 0.2;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--csv")
+        {
+            csv = true;
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc)
+        {
+            minSeconds = std::stod(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "usage: wgut_bench [--csv] [--filter SUBSTRING] [--min-time SECONDS]" << std::endl;
+            return 1;
+        }
+    }
+
+    Runner runner(filter, minSeconds);
+    Random random;
+    BenchFalg(runner, random);
+    auto ok = CheckFalg(random);
+    ok = CheckRaySlab() && ok;
+    ok = CheckMeshBvh() && ok;
+    ok = CheckSceneBvh() && ok;
+    ok = CheckOctree() && ok;
+    ok = BenchDispatch(runner, random) && ok;
+    BenchScene(runner, random);
+    BenchOctree(runner, random);
+    BenchMesh(runner, random);
+    BenchBvh(runner, random);
+    BenchOcclusion(runner, random);
+    BenchLod(runner, random);
+    BenchKdTree(runner, random);
+    BenchWeld(runner);
+    BenchVertexCache(runner, random);
+    BenchOverdraw(runner, random);
+    BenchVertexFetch(runner);
+    BenchMeshlets(runner);
+    BenchGizmo(runner);
+
+    if (csv)
+    {
+        WriteCsv(std::cout, runner.Results());
+    }
+    else
+    {
+        WriteJson(std::cout, runner.Results());
+    }
+    return ok ? 0 : 1;
+}
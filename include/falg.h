@@ -1,930 +1,3238 @@
-#pragma once
-#include <array>
-#include <limits>
-#include <vector>
-#define _USE_MATH_DEFINES
-#include <math.h>
-#include <cmath>
-
-///
-/// float algebra
-///
-/// TODO: use ROW vector & ROW major matrix
-///
-/// [COL vector] => x
-/// R|T   X   X'
-/// -+- * Y = Y'
-/// 0|1   Z   Z'
-/// #multiply order
-/// root * parent * local * col vector => vector
-///
-/// [ROW vector]
-///       R|0
-/// XYZ * -+- = X'Y'Z'
-///       T|1
-/// #multiply order
-/// row vector * local * parent * root => vector
-///
-/// [ROW major]
-/// matrix { m11, m12, m13, ... }
-///
-/// [COL major] => x
-/// matrix { m11, m21, m31, ... }
-///
-/// tradeoff
-/// => get translation from matrix
-/// => matrix apply vector function
-/// => matrix conversion function(ex. quaterion to matrix, decompose... etc)
-///
-/// upload [ROW vector][ROW major] matrix to d3d constant buffer
-/// mul(matrix, float4) [ROW vector usage]
-/// OK
-///
-/// if
-/// mul(float4, world) [COL vector usage]
-/// world is inversed
-///
-namespace falg
-{
-using float2 = std::array<float, 2>;
-using float3 = std::array<float, 3>;
-using float4 = std::array<float, 4>;
-using float16 = std::array<float, 16>;
-
-const float PI = (float)M_PI;
-const float TO_RADIANS = PI / 180.0f;
-
-template <typename T, typename S>
-inline const T &size_cast(const S &s)
-{
-    static_assert(sizeof(S) == sizeof(T), "must same size");
-    return *((T *)&s);
-}
-
-template <typename T, typename S>
-inline T &size_cast(S &s)
-{
-    static_assert(sizeof(S) == sizeof(T), "must same size");
-    return *((T *)&s);
-}
-
-struct range
-{
-    const void *begin;
-    const void *end;
-
-    size_t size() const
-    {
-        return (uint8_t *)end - (uint8_t *)begin;
-    }
-};
-
-template <typename T, typename S>
-inline const T &vector_cast(const std::vector<S> &s)
-{
-    range r{s.data(), s.data() + s.size()};
-    if (r.size() != sizeof(T))
-    {
-        throw;
-    }
-    return *(const T *)r.begin;
-}
-
-struct xyz
-{
-    float x;
-    float y;
-    float z;
-};
-struct xyzw
-{
-    float x;
-    float y;
-    float z;
-    float w;
-};
-struct row_matrix
-{
-    float _11;
-    float _12;
-    float _13;
-    float _14;
-    float _21;
-    float _22;
-    float _23;
-    float _24;
-    float _31;
-    float _32;
-    float _33;
-    float _34;
-    float _41;
-    float _42;
-    float _43;
-    float _44;
-};
-
-template <size_t MOD, size_t N>
-struct mul4
-{
-    // SFINAE for MOD not 0
-};
-template <size_t N>
-struct mul4<0, N>
-{
-    static const size_t value = N;
-};
-template <typename T>
-struct float_array
-{
-    static const size_t length = mul4<sizeof(T) % 4, sizeof(T) / 4>::value;
-    using type = std::array<float, length>;
-    template <typename S>
-    static const type &cast(const S &s)
-    {
-        return size_cast<type>(s);
-    }
-};
-
-template <typename T>
-inline bool Nearly(const T &lhs, const T &rhs)
-{
-    using ARRAY = float_array<T>;
-    auto &l = ARRAY::cast(lhs);
-    auto &r = ARRAY::cast(rhs);
-
-    const auto EPSILON = 1e-5f;
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        if (abs(l[i] - r[i]) > EPSILON)
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-template <typename T>
-inline T MulScalar(const T &value, float f)
-{
-    using ARRAY = float_array<T>;
-    auto v = ARRAY::cast(value);
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        v[i] *= f;
-    }
-    return size_cast<T>(v);
-}
-
-template <typename T>
-inline T Add(const T &lhs, const T &rhs)
-{
-    using ARRAY = float_array<T>;
-    auto &l = ARRAY::cast(lhs);
-    auto &r = ARRAY::cast(rhs);
-
-    T value;
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        value[i] = l[i] + r[i];
-    }
-    return size_cast<T>(value);
-}
-
-template <typename T>
-inline T Sub(const T &lhs, const T &rhs)
-{
-    using ARRAY = float_array<T>;
-    auto &l = ARRAY::cast(lhs);
-    auto &r = ARRAY::cast(rhs);
-
-    T value;
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        value[i] = l[i] - r[i];
-    }
-    return size_cast<T>(value);
-}
-
-template <typename T>
-inline T EachMul(const T &lhs, const T &rhs)
-{
-    using ARRAY = float_array<T>;
-    auto &l = ARRAY::cast(lhs);
-    auto &r = ARRAY::cast(rhs);
-
-    T value;
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        value[i] = l[i] * r[i];
-    }
-    return size_cast<T>(value);
-}
-
-template <typename T>
-inline float Dot(const T &lhs, const T &rhs)
-{
-    using ARRAY = float_array<T>;
-    auto &l = ARRAY::cast(lhs);
-    auto &r = ARRAY::cast(rhs);
-
-    float value = 0;
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        value += l[i] * r[i];
-    }
-    return value;
-}
-
-template <typename T>
-inline float Length(const T &src)
-{
-    return std::sqrt(Dot(src, src));
-}
-
-template <typename T>
-inline T Normalize(const T &src)
-{
-    using ARRAY = float_array<T>;
-    auto value = ARRAY::cast(src);
-    auto factor = 1.0f / Length(src);
-    for (size_t i = 0; i < ARRAY::length; ++i)
-    {
-        value[i] *= factor;
-    }
-    return size_cast<T>(value);
-}
-
-template <typename T>
-inline T Cross(const T &lhs, const T &rhs)
-{
-    auto &l = size_cast<xyz>(lhs);
-    auto &r = size_cast<xyz>(rhs);
-
-    xyz value{
-        l.y * r.z - l.z * r.y,
-        l.z * r.x - l.x * r.z,
-        l.x * r.y - l.y * r.x,
-    };
-    return size_cast<T>(value);
-}
-
-inline float Dot4(const float *row, const float *col, int step = 1)
-{
-    auto i = 0;
-    auto a = row[0] * col[i];
-    i += step;
-    auto b = row[1] * col[i];
-    i += step;
-    auto c = row[2] * col[i];
-    i += step;
-    auto d = row[3] * col[i];
-    auto value = a + b + c + d;
-    return value;
-}
-
-template <typename M, typename T>
-float3 RowMatrixApplyPosition(const M &_m, const T &_t)
-{
-    auto m = size_cast<row_matrix>(_m);
-    auto &t = size_cast<xyz>(_t);
-    std::array<float, 4> v = {t.x, t.y, t.z, 1};
-    return {
-        Dot4(v.data(), &m._11, 4),
-        Dot4(v.data(), &m._12, 4),
-        Dot4(v.data(), &m._13, 4)
-    };
-}
-
-//
-
-inline std::array<float, 16> RowMatrixMul(const std::array<float, 16> &l, const std::array<float, 16> &r)
-{
-    auto _11 = Dot4(&l[0], &r[0], 4);
-    auto _12 = Dot4(&l[0], &r[1], 4);
-    auto _13 = Dot4(&l[0], &r[2], 4);
-    auto _14 = Dot4(&l[0], &r[3], 4);
-    auto _21 = Dot4(&l[4], &r[0], 4);
-    auto _22 = Dot4(&l[4], &r[1], 4);
-    auto _23 = Dot4(&l[4], &r[2], 4);
-    auto _24 = Dot4(&l[4], &r[3], 4);
-    auto _31 = Dot4(&l[8], &r[0], 4);
-    auto _32 = Dot4(&l[8], &r[1], 4);
-    auto _33 = Dot4(&l[8], &r[2], 4);
-    auto _34 = Dot4(&l[8], &r[3], 4);
-    auto _41 = Dot4(&l[12], &r[0], 4);
-    auto _42 = Dot4(&l[12], &r[1], 4);
-    auto _43 = Dot4(&l[12], &r[2], 4);
-    auto _44 = Dot4(&l[12], &r[3], 4);
-
-    return std::array<float, 16>{
-        _11,
-        _12,
-        _13,
-        _14,
-        _21,
-        _22,
-        _23,
-        _24,
-        _31,
-        _32,
-        _33,
-        _34,
-        _41,
-        _42,
-        _43,
-        _44,
-    };
-}
-} // namespace falg
-
-namespace std
-{
-inline falg::float16 operator*(const falg::float16 &lhs, const falg::float16 &rhs)
-{
-    return falg::RowMatrixMul(lhs, rhs);
-}
-} // namespace std
-
-namespace falg
-{
-
-inline void Transpose(std::array<float, 16> &m)
-{
-    std::swap(m[1], m[4]);
-    std::swap(m[2], m[8]);
-    std::swap(m[3], m[12]);
-    std::swap(m[6], m[9]);
-    std::swap(m[7], m[13]);
-    std::swap(m[11], m[14]);
-}
-
-inline std::array<float, 16> IdentityMatrix()
-{
-    return std::array<float, 16>{
-        1,
-        0,
-        0,
-        0,
-        0,
-        1,
-        0,
-        0,
-        0,
-        0,
-        1,
-        0,
-        0,
-        0,
-        0,
-        1,
-    };
-}
-
-inline std::array<float, 16> YawMatrix(float yawRadians)
-{
-    auto ys = (float)sin(yawRadians);
-    auto yc = (float)cos(yawRadians);
-    std::array<float, 16> yaw = {
-        yc,
-        0,
-        ys,
-        0,
-
-        0,
-        1,
-        0,
-        0,
-
-        -ys,
-        0,
-        yc,
-        0,
-
-        0,
-        0,
-        0,
-        1,
-    };
-    return yaw;
-}
-
-inline std::array<float, 16> PitchMatrix(float pitchRadians)
-{
-    auto ps = (float)sin(pitchRadians);
-    auto pc = (float)cos(pitchRadians);
-    std::array<float, 16> pitch = {
-        1,
-        0,
-        0,
-        0,
-
-        0,
-        pc,
-        ps,
-        0,
-
-        0,
-        -ps,
-        pc,
-        0,
-
-        0,
-        0,
-        0,
-        1,
-    };
-    return pitch;
-}
-
-inline std::array<float, 16> TranslationMatrix(float x, float y, float z)
-{
-    std::array<float, 16> t = {
-        1,
-        0,
-        0,
-        0,
-        0,
-        1,
-        0,
-        0,
-        0,
-        0,
-        1,
-        0,
-        x,
-        y,
-        z,
-        1,
-    };
-    return t;
-}
-
-inline double Cot(double value)
-{
-    return 1.0f / tan(value);
-}
-
-inline void PerspectiveRHGL(float projection[16], float fovYRadians, float aspectRatio, float zNear, float zFar)
-{
-    const float f = static_cast<float>(Cot(fovYRadians / 2.0));
-    projection[0] = f / aspectRatio;
-    projection[1] = 0.0f;
-    projection[2] = 0.0f;
-    projection[3] = 0.0f;
-
-    projection[4] = 0.0f;
-    projection[5] = f;
-    projection[6] = 0.0f;
-    projection[7] = 0.0f;
-
-    projection[8] = 0.0f;
-    projection[9] = 0.0f;
-    projection[10] = (zNear + zFar) / (zNear - zFar);
-    projection[11] = -1;
-
-    projection[12] = 0.0f;
-    projection[13] = 0.0f;
-    projection[14] = (2 * zFar * zNear) / (zNear - zFar);
-    projection[15] = 0.0f;
-}
-
-inline void PerspectiveRHDX(float projection[16], float fovYRadians, float aspectRatio, float zNear, float zFar)
-{
-    auto yScale = (float)Cot(fovYRadians / 2);
-    auto xScale = yScale / aspectRatio;
-    projection[0] = xScale;
-    projection[1] = 0.0f;
-    projection[2] = 0.0f;
-    projection[3] = 0.0f;
-
-    projection[4] = 0.0f;
-    projection[5] = yScale;
-    projection[6] = 0.0f;
-    projection[7] = 0.0f;
-
-    projection[8] = 0.0f;
-    projection[9] = 0.0f;
-    projection[10] = zFar / (zNear - zFar);
-    projection[11] = -1;
-
-    projection[12] = 0.0f;
-    projection[13] = 0.0f;
-    projection[14] = (zFar * zNear) / (zNear - zFar);
-    projection[15] = 0.0f;
-}
-
-inline float4 QuaternionAxisAngle(const float3 &axis, float angle)
-{
-    auto angle_half = angle / 2;
-    auto sin = std::sin(angle_half);
-    auto cos = std::cos(angle_half);
-    return {axis[0] * sin, axis[1] * sin, axis[2] * sin, cos};
-}
-
-// inline float4 QuaternionMul(const float4 &lhs, const float4 &rhs)
-// {
-//     return {lhs[0] * rhs[3] + lhs[3] * rhs[0] + lhs[1] * rhs[2] - lhs[2] * rhs[1],
-//             lhs[1] * rhs[3] + lhs[3] * rhs[1] + lhs[2] * rhs[0] - lhs[0] * rhs[2],
-//             lhs[2] * rhs[3] + lhs[3] * rhs[2] + lhs[0] * rhs[1] - lhs[1] * rhs[0],
-//             lhs[3] * rhs[3] - lhs[0] * rhs[0] - lhs[1] * rhs[1] - lhs[2] * rhs[2]};
-// }
-template <typename T>
-inline float4 QuaternionMul(const T &l, T r)
-{
-    if (Dot(l, r) < 0)
-    {
-        r = {-r[0], -r[1], -r[2], -r[3]};
-    }
-    const auto &lhs = size_cast<xyzw>(l);
-    const auto &rhs = size_cast<xyzw>(r);
-    return {rhs.x * lhs.w + rhs.w * lhs.x + rhs.y * lhs.z - rhs.z * lhs.y,
-            rhs.y * lhs.w + rhs.w * lhs.y + rhs.z * lhs.x - rhs.x * lhs.z,
-            rhs.z * lhs.w + rhs.w * lhs.z + rhs.x * lhs.y - rhs.y * lhs.x,
-            rhs.w * lhs.w - rhs.x * lhs.x - rhs.y * lhs.y - rhs.z * lhs.z};
-}
-// inline float4 operator*(const float4 &lhs, const float4 &rhs)
-// {
-//     float ax = lhs[0];
-//     float ay = lhs[1];
-//     float az = lhs[2];
-//     float aw = lhs[3];
-//     float bx = rhs[0];
-//     float by = rhs[1];
-//     float bz = rhs[2];
-//     float bw = rhs[3];
-//     return {
-//         ax * bw + aw * bx + ay * bz - az * by,
-//         ay * bw + aw * by + az * bx - ax * bz,
-//         az * bw + aw * bz + ax * by - ay * bx,
-//         aw * bw - ax * bx - ay * by - az * bz,
-//     };
-// }
-
-inline float4 QuaternionConjugate(const float4 &v)
-{
-    return {-v[0], -v[1], -v[2], v[3]};
-}
-
-inline float3 QuaternionXDir(const float4 &v)
-{
-    auto x = v[0];
-    auto y = v[1];
-    auto z = v[2];
-    auto w = v[3];
-    return {w * w + x * x - y * y - z * z, (x * y + z * w) * 2, (z * x - y * w) * 2};
-}
-
-inline float3 QuaternionYDir(const float4 &v)
-{
-    auto x = v[0];
-    auto y = v[1];
-    auto z = v[2];
-    auto w = v[3];
-    return {(x * y - z * w) * 2, w * w - x * x + y * y - z * z, (y * z + x * w) * 2};
-}
-
-inline float3 QuaternionZDir(const float4 &v)
-{
-    auto x = v[0];
-    auto y = v[1];
-    auto z = v[2];
-    auto w = v[3];
-    return {(z * x + y * w) * 2, (y * z - x * w) * 2, w * w - x * x - y * y + z * z};
-}
-
-inline std::array<float, 16> QuaternionMatrix(const float4 &q)
-{
-    auto x = QuaternionXDir(q);
-    auto y = QuaternionYDir(q);
-    auto z = QuaternionZDir(q);
-    return {
-        x[0], x[1], x[2], 0,
-        y[0], y[1], y[2], 0,
-        z[0], z[1], z[2], 0,
-        0, 0, 0, 1};
-}
-
-inline std::array<float, 16> ScaleMatrix(const float3 &s)
-{
-    return {
-        s[0], 0, 0, 0,
-        0, s[1], 0, 0,
-        0, 0, s[2], 0,
-        0, 0, 0, 1};
-}
-
-inline std::array<float, 16> ScaleMatrix(float x, float y, float z)
-{
-    return ScaleMatrix({x, y, z});
-}
-
-inline float3 QuaternionRotateFloat3(const float4 &q, const float3 &v)
-{
-    auto x = QuaternionXDir(q);
-    auto y = QuaternionYDir(q);
-    auto z = QuaternionZDir(q);
-    return Add(MulScalar(x, v[0]), Add(MulScalar(y, v[1]), MulScalar(z, v[2])));
-}
-
-struct Transform
-{
-    float3 translation{0, 0, 0};
-    float4 rotation{0, 0, 0, 1};
-
-    Transform operator*(const Transform &rhs) const
-    {
-        return {
-            Add(QuaternionRotateFloat3(rhs.rotation, translation), rhs.translation),
-            QuaternionMul(rotation, rhs.rotation)};
-    }
-
-    std::array<float, 16> RowMatrix() const
-    {
-        auto r = QuaternionMatrix(rotation);
-        r[12] = translation[0];
-        r[13] = translation[1];
-        r[14] = translation[2];
-        return r;
-    }
-
-    Transform Inverse() const
-    {
-        auto inv_r = QuaternionConjugate(rotation);
-        auto inv_t = QuaternionRotateFloat3(inv_r, MulScalar(translation, -1));
-        return {inv_t, inv_r};
-    }
-
-    float3 ApplyPosition(const float3 &v) const
-    {
-        return Add(QuaternionRotateFloat3(rotation, v), translation);
-    }
-
-    float3 ApplyDirection(const float3 &v) const
-    {
-        return QuaternionRotateFloat3(rotation, v);
-    }
-};
-
-struct TRS
-{
-    union {
-        Transform transform;
-        struct
-        {
-            float3 translation;
-            float4 rotation;
-        };
-    };
-    float3 scale;
-
-    TRS()
-        : translation({0, 0, 0}), rotation({0, 0, 0, 1}), scale({1, 1, 1})
-    {
-    }
-
-    TRS(const float3 &t, const float4 &r, const float3 &s)
-        : translation(t), rotation(r), scale(s)
-    {
-    }
-
-    std::array<float, 16> RowMatrix() const
-    {
-        return ScaleMatrix(scale) * transform.RowMatrix();
-    }
-};
-static_assert(sizeof(TRS) == 40, "TRS");
-
-template <typename T>
-TRS RowMatrixDecompose(const T &_m)
-{
-    auto &m = size_cast<row_matrix>(_m);
-    auto s1 = Length(float3{m._11, m._12, m._13});
-    auto s2 = Length(float3{m._21, m._22, m._23});
-    auto s3 = Length(float3{m._31, m._32, m._33});
-    TRS trs({m._41, m._42, m._43}, RowMatrixToQuaternion(_m), {s1, s2, s3});
-    return trs;
-}
-
-struct Ray
-{
-    float3 origin;
-    float3 direction;
-
-    Ray(const float3 &_origin, const float3 &_direction)
-        : origin(_origin), direction(_direction)
-    {
-    }
-
-    template <typename T>
-    Ray(const T &t)
-    {
-        static_assert(sizeof(T) == sizeof(Ray), "Ray::Ray()");
-        auto &ray = size_cast<Ray>(t);
-        origin = ray.origin;
-        direction = ray.direction;
-    }
-
-    Ray ToLocal(const falg::Transform &t) const
-    {
-        auto toLocal = t.Inverse();
-        return {
-            toLocal.ApplyPosition(origin),
-            falg::QuaternionRotateFloat3(toLocal.rotation, direction)};
-    }
-
-    float3 SetT(float t) const
-    {
-        return Add(origin, MulScalar(direction, t));
-    }
-
-    Ray Transform(const falg::Transform &t) const
-    {
-        return {
-            t.ApplyPosition(origin),
-            t.ApplyDirection(direction),
-        };
-    }
-};
-
-struct Plane
-{
-    float3 normal;
-    float3 pointOnPlane;
-
-    Plane(const float3 &n, const float3 &point_on_plane)
-        : normal(n), pointOnPlane(point_on_plane)
-    {
-    }
-};
-
-inline float operator>>(const Ray &ray, const Plane &plane)
-{
-    auto NV = Dot(plane.normal, ray.direction);
-    if (NV == 0)
-    {
-        // not intersect
-        return -std::numeric_limits<float>::infinity();
-    }
-
-    auto Q = Sub(plane.pointOnPlane, ray.origin);
-    auto NQ = Dot(plane.normal, Q);
-    return NQ / NV;
-}
-
-struct Triangle
-{
-    float3 v0;
-    float3 v1;
-    float3 v2;
-};
-
-// float intersect_ray_triangle(const ray &ray, const minalg::float3 &v0, const minalg::float3 &v1, const minalg::float3 &v2)
-inline float operator>>(const Ray &ray, const Triangle &triangle)
-{
-    auto e1 = Sub(triangle.v1, triangle.v0);
-    auto e2 = Sub(triangle.v2, triangle.v0);
-    auto h = Cross(ray.direction, e2);
-    auto a = Dot(e1, h);
-    if (std::abs(a) == 0)
-        return std::numeric_limits<float>::infinity();
-
-    float f = 1 / a;
-    auto s = Sub(ray.origin, triangle.v0);
-    auto u = f * Dot(s, h);
-    if (u < 0 || u > 1)
-        return std::numeric_limits<float>::infinity();
-
-    auto q = Cross(s, e1);
-    auto v = f * Dot(ray.direction, q);
-    if (v < 0 || u + v > 1)
-        return std::numeric_limits<float>::infinity();
-
-    auto t = f * Dot(e2, q);
-    if (t < 0)
-        return std::numeric_limits<float>::infinity();
-
-    return t;
-}
-
-struct Matrix2x3
-{
-    float3 x;
-    float3 y;
-
-    float3 Apply(const float2 &value) const
-    {
-        return {
-            x[0] * value[0] + y[0] * value[1],
-            x[1] * value[0] + y[1] * value[1],
-            x[2] * value[0] + y[2] * value[1],
-        };
-    }
-};
-
-struct m16
-{
-    float _11, _12, _13, _14;
-    float _21, _22, _23, _24;
-    float _31, _32, _33, _34;
-    float _41, _42, _43, _44;
-};
-
-inline std::array<float, 3> MatrixToTranslation(const m16 &m)
-{
-    return {m._41, m._42, m._43};
-}
-
-template <typename T>
-std::array<float, 3> MatrixToTranslation(const T &m)
-{
-    return MatrixToTranslation(size_cast<m16>(m));
-}
-
-inline std::array<float, 4> ColMatrixToQuaternion(const m16 &m)
-{
-    float x, y, z, w;
-    float trace = m._11 + m._22 + m._33; // I removed + 1.0f; see discussion with Ethan
-    if (trace > 0)
-    { // I changed M_EPSILON to 0
-        float s = 0.5f / sqrtf(trace + 1.0f);
-        w = 0.25f / s;
-        x = (m._32 - m._23) * s;
-        y = (m._13 - m._31) * s;
-        z = (m._21 - m._12) * s;
-    }
-    else
-    {
-        if (m._11 > m._22 && m._22 > m._33)
-        {
-            float s = 2.0f * sqrtf(1.0f + m._11 - m._22 - m._33);
-            w = (m._32 - m._23) / s;
-            x = 0.25f * s;
-            y = (m._12 + m._21) / s;
-            z = (m._13 + m._31) / s;
-        }
-        else if (m._22 > m._33)
-        {
-            float s = 2.0f * sqrtf(1.0f + m._22 - m._11 - m._33);
-            w = (m._13 - m._31) / s;
-            x = (m._12 + m._21) / s;
-            y = 0.25f * s;
-            z = (m._23 + m._32) / s;
-        }
-        else
-        {
-            float s = 2.0f * sqrtf(1.0f + m._33 - m._11 - m._22);
-            w = (m._21 - m._12) / s;
-            x = (m._13 + m._31) / s;
-            y = (m._23 + m._32) / s;
-            z = 0.25f * s;
-        }
-    }
-    return {x, y, z, w};
-}
-
-template <typename T>
-std::array<float, 4> ColMatrixToQuaternion(const T &m)
-{
-    return ColMatrixToQuaternion(size_cast<m16>(m));
-}
-
-template <typename T>
-std::array<float, 4> RowMatrixToQuaternion(const T &m)
-{
-    return QuaternionConjugate(ColMatrixToQuaternion(size_cast<m16>(m)));
-}
-
-} // namespace falg
-
-/////////////////////////////////////////////////////////////////////////////
-// std
-/////////////////////////////////////////////////////////////////////////////
-namespace std
-{
-
-// for std::array
-inline falg::float3 operator-(const falg::float3 &lhs)
-{
-    return {-lhs[0], -lhs[1], -lhs[2]};
-}
-inline falg::float3 operator+(const falg::float3 &lhs, const falg::float3 &rhs)
-{
-    return {lhs[0] + rhs[0], lhs[1] + rhs[1], lhs[2] + rhs[2]};
-}
-inline falg::float3 &operator+=(falg::float3 &lhs, const falg::float3 &rhs)
-{
-    lhs[0] += rhs[0];
-    lhs[1] += rhs[1];
-    lhs[2] += rhs[2];
-    return lhs;
-}
-inline falg::float3 operator-(const falg::float3 &lhs, const falg::float3 &rhs)
-{
-    return {lhs[0] - rhs[0], lhs[1] - rhs[1], lhs[2] - rhs[2]};
-}
-inline falg::float3 operator*(const falg::float3 &lhs, float scalar)
-{
-    return {lhs[0] * scalar, lhs[1] * scalar, lhs[2] * scalar};
-}
-
-} // namespace std
+#pragma once
+#include <array>
+#include <bit>
+#include <limits>
+#include <vector>
+#include <span>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <cmath>
+
+///
+/// SIMD
+///
+/// SSE2 is used when the target has it (x64 always). AVX when compiled with /arch:AVX or -mavx.
+/// define FALG_NO_SIMD to use scalar code only.
+/// every SIMD path keeps the operation order of the scalar code, results are bit exact
+/// (as long as the compiler does not contract the scalar code into FMA, -ffp-contract=off).
+///
+#if !defined(FALG_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FALG_SSE2 1
+#endif
+#if defined(FALG_SSE2) && defined(__AVX__)
+#define FALG_AVX 1
+#endif
+#if defined(FALG_AVX) && (defined(__F16C__) || defined(__AVX2__))
+#define FALG_F16C 1
+#endif
+#endif
+
+#if defined(FALG_SSE2)
+#include <immintrin.h>
+#endif
+
+///
+/// AVX kernels are always compiled on x86 with FALG_TARGET and may be called after a runtime check
+/// (falg_dispatch.h). without /arch:AVX or -mavx the inline functions use them only through dispatch.
+///
+#if defined(_MSC_VER) && !defined(__clang__)
+#define FALG_TARGET(isa)
+#else
+#define FALG_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+///
+/// float algebra
+///
+/// TODO: use ROW vector & ROW major matrix
+///
+/// [COL vector] => x
+/// R|T   X   X'
+/// -+- * Y = Y'
+/// 0|1   Z   Z'
+/// #multiply order
+/// root * parent * local * col vector => vector
+///
+/// [ROW vector]
+///       R|0
+/// XYZ * -+- = X'Y'Z'
+///       T|1
+/// #multiply order
+/// row vector * local * parent * root => vector
+///
+/// [ROW major]
+/// matrix { m11, m12, m13, ... }
+///
+/// [COL major] => x
+/// matrix { m11, m21, m31, ... }
+///
+/// tradeoff
+/// => get translation from matrix
+/// => matrix apply vector function
+/// => matrix conversion function(ex. quaterion to matrix, decompose... etc)
+///
+/// upload [ROW vector][ROW major] matrix to d3d constant buffer
+/// mul(matrix, float4) [ROW vector usage]
+/// OK
+///
+/// if
+/// mul(float4, world) [COL vector usage]
+/// world is inversed
+///
+namespace falg
+{
+using float2 = std::array<float, 2>;
+using float3 = std::array<float, 3>;
+using float4 = std::array<float, 4>;
+using float16 = std::array<float, 16>;
+
+const float PI = (float)M_PI;
+const float TO_RADIANS = PI / 180.0f;
+
+template <typename T, typename S>
+inline const T &size_cast(const S &s)
+{
+    static_assert(sizeof(S) == sizeof(T), "must same size");
+    return *((T *)&s);
+}
+
+template <typename T, typename S>
+inline T &size_cast(S &s)
+{
+    static_assert(sizeof(S) == sizeof(T), "must same size");
+    return *((T *)&s);
+}
+
+struct range
+{
+    const void *begin;
+    const void *end;
+
+    size_t size() const
+    {
+        return (uint8_t *)end - (uint8_t *)begin;
+    }
+};
+
+template <typename T, typename S>
+inline const T &vector_cast(const std::vector<S> &s)
+{
+    range r{s.data(), s.data() + s.size()};
+    if (r.size() != sizeof(T))
+    {
+        throw;
+    }
+    return *(const T *)r.begin;
+}
+
+struct xyz
+{
+    float x;
+    float y;
+    float z;
+};
+struct xyzw
+{
+    float x;
+    float y;
+    float z;
+    float w;
+};
+struct row_matrix
+{
+    float _11;
+    float _12;
+    float _13;
+    float _14;
+    float _21;
+    float _22;
+    float _23;
+    float _24;
+    float _31;
+    float _32;
+    float _33;
+    float _34;
+    float _41;
+    float _42;
+    float _43;
+    float _44;
+};
+
+template <size_t MOD, size_t N>
+struct mul4
+{
+    // SFINAE for MOD not 0
+};
+template <size_t N>
+struct mul4<0, N>
+{
+    static const size_t value = N;
+};
+template <typename T>
+struct float_array
+{
+    static const size_t length = mul4<sizeof(T) % 4, sizeof(T) / 4>::value;
+    using type = std::array<float, length>;
+    template <typename S>
+    static const type &cast(const S &s)
+    {
+        return size_cast<type>(s);
+    }
+
+    // copy as std::array. no reinterpret for std::array, usable in constant expressions
+    static constexpr type load(const T &t)
+    {
+        if constexpr (std::is_same_v<T, type>)
+        {
+            return t;
+        }
+        else
+        {
+            return cast(t);
+        }
+    }
+
+    static constexpr T store(const type &t)
+    {
+        if constexpr (std::is_same_v<T, type>)
+        {
+            return t;
+        }
+        else
+        {
+            return size_cast<T>(t);
+        }
+    }
+};
+
+template <typename T>
+inline bool Nearly(const T &lhs, const T &rhs)
+{
+    using ARRAY = float_array<T>;
+    auto &l = ARRAY::cast(lhs);
+    auto &r = ARRAY::cast(rhs);
+
+    const auto EPSILON = 1e-5f;
+    for (size_t i = 0; i < ARRAY::length; ++i)
+    {
+        if (abs(l[i] - r[i]) > EPSILON)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+constexpr T MulScalar(const T &value, float f)
+{
+    using ARRAY = float_array<T>;
+    auto v = ARRAY::load(value);
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    if (!std::is_constant_evaluated())
+    {
+        auto s = _mm_set1_ps(f);
+        for (; i + 4 <= ARRAY::length; i += 4)
+        {
+            _mm_storeu_ps(&v[i], _mm_mul_ps(_mm_loadu_ps(&v[i]), s));
+        }
+    }
+#endif
+    for (; i < ARRAY::length; ++i)
+    {
+        v[i] *= f;
+    }
+    return ARRAY::store(v);
+}
+
+template <typename T>
+constexpr T Add(const T &lhs, const T &rhs)
+{
+    using ARRAY = float_array<T>;
+    auto l = ARRAY::load(lhs);
+    auto r = ARRAY::load(rhs);
+
+    typename ARRAY::type value{};
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    if (!std::is_constant_evaluated())
+    {
+        for (; i + 4 <= ARRAY::length; i += 4)
+        {
+            _mm_storeu_ps(&value[i], _mm_add_ps(_mm_loadu_ps(&l[i]), _mm_loadu_ps(&r[i])));
+        }
+    }
+#endif
+    for (; i < ARRAY::length; ++i)
+    {
+        value[i] = l[i] + r[i];
+    }
+    return ARRAY::store(value);
+}
+
+template <typename T>
+constexpr T Sub(const T &lhs, const T &rhs)
+{
+    using ARRAY = float_array<T>;
+    auto l = ARRAY::load(lhs);
+    auto r = ARRAY::load(rhs);
+
+    typename ARRAY::type value{};
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    if (!std::is_constant_evaluated())
+    {
+        for (; i + 4 <= ARRAY::length; i += 4)
+        {
+            _mm_storeu_ps(&value[i], _mm_sub_ps(_mm_loadu_ps(&l[i]), _mm_loadu_ps(&r[i])));
+        }
+    }
+#endif
+    for (; i < ARRAY::length; ++i)
+    {
+        value[i] = l[i] - r[i];
+    }
+    return ARRAY::store(value);
+}
+
+template <typename T>
+constexpr T EachMul(const T &lhs, const T &rhs)
+{
+    using ARRAY = float_array<T>;
+    auto l = ARRAY::load(lhs);
+    auto r = ARRAY::load(rhs);
+
+    typename ARRAY::type value{};
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    if (!std::is_constant_evaluated())
+    {
+        for (; i + 4 <= ARRAY::length; i += 4)
+        {
+            _mm_storeu_ps(&value[i], _mm_mul_ps(_mm_loadu_ps(&l[i]), _mm_loadu_ps(&r[i])));
+        }
+    }
+#endif
+    for (; i < ARRAY::length; ++i)
+    {
+        value[i] = l[i] * r[i];
+    }
+    return ARRAY::store(value);
+}
+
+template <typename T>
+constexpr float Dot(const T &lhs, const T &rhs)
+{
+    using ARRAY = float_array<T>;
+    auto l = ARRAY::load(lhs);
+    auto r = ARRAY::load(rhs);
+
+    float value = 0;
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    if (!std::is_constant_evaluated())
+    {
+        // products in SIMD, sum in scalar order
+        for (; i + 4 <= ARRAY::length; i += 4)
+        {
+            alignas(16) float m[4];
+            _mm_store_ps(m, _mm_mul_ps(_mm_loadu_ps(&l[i]), _mm_loadu_ps(&r[i])));
+            value += m[0];
+            value += m[1];
+            value += m[2];
+            value += m[3];
+        }
+    }
+#endif
+    for (; i < ARRAY::length; ++i)
+    {
+        value += l[i] * r[i];
+    }
+    return value;
+}
+
+template <typename T>
+inline float Length(const T &src)
+{
+    return std::sqrt(Dot(src, src));
+}
+
+template <typename T>
+inline T Normalize(const T &src)
+{
+    return MulScalar(src, 1.0f / Length(src));
+}
+
+template <typename T>
+constexpr T Cross(const T &lhs, const T &rhs)
+{
+    using ARRAY = float_array<T>;
+    static_assert(ARRAY::length == 3, "Cross");
+    auto l = ARRAY::load(lhs);
+    auto r = ARRAY::load(rhs);
+
+    return ARRAY::store({
+        l[1] * r[2] - l[2] * r[1],
+        l[2] * r[0] - l[0] * r[2],
+        l[0] * r[1] - l[1] * r[0],
+    });
+}
+
+///
+/// fused
+///
+/// one pass over the elements, no temporary vector per operation.
+/// same operation order and results as the nested Add / MulScalar.
+///
+/// MulAdd(a, s, b) == Add(MulScalar(a, s), b)
+/// LinearCombination(a, s, b, t, c, u) == Add(MulScalar(a, s), Add(MulScalar(b, t), MulScalar(c, u)))
+///
+namespace detail
+{
+constexpr float as_term(float f)
+{
+    return f;
+}
+
+// std::array by reference, others as a copy
+template <typename T>
+constexpr decltype(auto) as_term(const T &t)
+{
+    if constexpr (std::is_same_v<T, typename float_array<T>::type>)
+    {
+        return (t);
+    }
+    else
+    {
+        return float_array<T>::load(t);
+    }
+}
+
+template <size_t N>
+constexpr float combination_at(size_t i, const std::array<float, N> &a, float s)
+{
+    return a[i] * s;
+}
+
+template <size_t N, typename... REST>
+constexpr float combination_at(size_t i, const std::array<float, N> &a, float s, const REST &...rest)
+{
+    return a[i] * s + combination_at(i, rest...);
+}
+
+#if defined(FALG_SSE2)
+template <size_t N>
+inline __m128 combination_sse(size_t i, const std::array<float, N> &a, float s)
+{
+    return _mm_mul_ps(_mm_loadu_ps(&a[i]), _mm_set1_ps(s));
+}
+
+template <size_t N, typename... REST>
+inline __m128 combination_sse(size_t i, const std::array<float, N> &a, float s, const REST &...rest)
+{
+    return _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&a[i]), _mm_set1_ps(s)), combination_sse(i, rest...));
+}
+#endif
+
+// unrolled. a loop over 3 elements is not unrolled at -O2 and goes through the stack
+template <size_t N, size_t... I, typename... REST>
+constexpr std::array<float, N> linear_combination_unrolled(std::index_sequence<I...>, const std::array<float, N> &a, float s, const REST &...rest)
+{
+    return {combination_at(I, a, s, rest...)...};
+}
+
+template <size_t N, typename... REST>
+constexpr std::array<float, N> linear_combination(const std::array<float, N> &a, float s, const REST &...rest)
+{
+#if defined(FALG_SSE2)
+    if constexpr (N % 4 == 0)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            std::array<float, N> value;
+            [&]<size_t... I>(std::index_sequence<I...>)
+            {
+                (_mm_storeu_ps(&value[I * 4], combination_sse(I * 4, a, s, rest...)), ...);
+            }
+            (std::make_index_sequence<N / 4>());
+            return value;
+        }
+    }
+#endif
+    return linear_combination_unrolled(std::make_index_sequence<N>(), a, s, rest...);
+}
+} // namespace detail
+
+// a * s + (b * t + (c * u + ...)). pairs of vector and scalar
+template <typename T, typename... REST>
+constexpr T LinearCombination(const T &a, float s, const REST &...rest)
+{
+    static_assert(sizeof...(REST) % 2 == 0, "LinearCombination: vector, scalar pairs");
+    using ARRAY = float_array<T>;
+    return ARRAY::store(detail::linear_combination(detail::as_term(a), s, detail::as_term(rest)...));
+}
+
+// b * 1 is exact
+template <typename T>
+constexpr T MulAdd(const T &a, float s, const T &b)
+{
+    return LinearCombination(a, s, b, 1.0f);
+}
+
+constexpr float Dot4(const float *row, const float *col, int step = 1)
+{
+    auto i = 0;
+    auto a = row[0] * col[i];
+    i += step;
+    auto b = row[1] * col[i];
+    i += step;
+    auto c = row[2] * col[i];
+    i += step;
+    auto d = row[3] * col[i];
+    auto value = a + b + c + d;
+    return value;
+}
+
+template <typename M, typename T>
+float3 RowMatrixApplyPosition(const M &_m, const T &_t)
+{
+    auto m = size_cast<row_matrix>(_m);
+    auto &t = size_cast<xyz>(_t);
+    std::array<float, 4> v = {t.x, t.y, t.z, 1};
+    return {
+        Dot4(v.data(), &m._11, 4),
+        Dot4(v.data(), &m._12, 4),
+        Dot4(v.data(), &m._13, 4)
+    };
+}
+
+//
+
+// reference implementation
+constexpr std::array<float, 16> RowMatrixMulScalar(const std::array<float, 16> &l, const std::array<float, 16> &r)
+{
+    auto _11 = Dot4(&l[0], &r[0], 4);
+    auto _12 = Dot4(&l[0], &r[1], 4);
+    auto _13 = Dot4(&l[0], &r[2], 4);
+    auto _14 = Dot4(&l[0], &r[3], 4);
+    auto _21 = Dot4(&l[4], &r[0], 4);
+    auto _22 = Dot4(&l[4], &r[1], 4);
+    auto _23 = Dot4(&l[4], &r[2], 4);
+    auto _24 = Dot4(&l[4], &r[3], 4);
+    auto _31 = Dot4(&l[8], &r[0], 4);
+    auto _32 = Dot4(&l[8], &r[1], 4);
+    auto _33 = Dot4(&l[8], &r[2], 4);
+    auto _34 = Dot4(&l[8], &r[3], 4);
+    auto _41 = Dot4(&l[12], &r[0], 4);
+    auto _42 = Dot4(&l[12], &r[1], 4);
+    auto _43 = Dot4(&l[12], &r[2], 4);
+    auto _44 = Dot4(&l[12], &r[3], 4);
+
+    return std::array<float, 16>{
+        _11,
+        _12,
+        _13,
+        _14,
+        _21,
+        _22,
+        _23,
+        _24,
+        _31,
+        _32,
+        _33,
+        _34,
+        _41,
+        _42,
+        _43,
+        _44,
+    };
+}
+
+#if defined(FALG_SSE2)
+// two rows at once. ((a + b) + c) + d same as Dot4
+FALG_TARGET("avx") inline std::array<float, 16> RowMatrixMulAVX(const std::array<float, 16> &l, const std::array<float, 16> &r)
+{
+    auto r0 = _mm256_broadcast_ps((const __m128 *)&r[0]);
+    auto r1 = _mm256_broadcast_ps((const __m128 *)&r[4]);
+    auto r2 = _mm256_broadcast_ps((const __m128 *)&r[8]);
+    auto r3 = _mm256_broadcast_ps((const __m128 *)&r[12]);
+    std::array<float, 16> m;
+    for (int i = 0; i < 16; i += 8)
+    {
+        auto rows = _mm256_loadu_ps(&l[i]);
+        auto v = _mm256_mul_ps(_mm256_permute_ps(rows, 0x00), r0);
+        v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_permute_ps(rows, 0x55), r1));
+        v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_permute_ps(rows, 0xAA), r2));
+        v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_permute_ps(rows, 0xFF), r3));
+        _mm256_storeu_ps(&m[i], v);
+    }
+    return m;
+}
+#endif
+
+#if defined(FALG_SSE2)
+// row i = l[i][0] * r[0] + l[i][1] * r[1] + ... same order as Dot4
+inline std::array<float, 16> RowMatrixMulSSE2(const std::array<float, 16> &l, const std::array<float, 16> &r)
+{
+    auto r0 = _mm_loadu_ps(&r[0]);
+    auto r1 = _mm_loadu_ps(&r[4]);
+    auto r2 = _mm_loadu_ps(&r[8]);
+    auto r3 = _mm_loadu_ps(&r[12]);
+    std::array<float, 16> m;
+    for (int i = 0; i < 16; i += 4)
+    {
+        auto v = _mm_mul_ps(_mm_set1_ps(l[i]), r0);
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(l[i + 1]), r1));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(l[i + 2]), r2));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(l[i + 3]), r3));
+        _mm_storeu_ps(&m[i], v);
+    }
+    return m;
+}
+#endif
+
+constexpr std::array<float, 16> RowMatrixMul(const std::array<float, 16> &l, const std::array<float, 16> &r)
+{
+    if (std::is_constant_evaluated())
+    {
+        return RowMatrixMulScalar(l, r);
+    }
+#if defined(FALG_AVX)
+    return RowMatrixMulAVX(l, r);
+#elif defined(FALG_SSE2)
+    return RowMatrixMulSSE2(l, r);
+#else
+    return RowMatrixMulScalar(l, r);
+#endif
+}
+} // namespace falg
+
+namespace std
+{
+constexpr falg::float16 operator*(const falg::float16 &lhs, const falg::float16 &rhs)
+{
+    return falg::RowMatrixMul(lhs, rhs);
+}
+} // namespace std
+
+namespace falg
+{
+
+constexpr void Transpose(std::array<float, 16> &m)
+{
+    std::swap(m[1], m[4]);
+    std::swap(m[2], m[8]);
+    std::swap(m[3], m[12]);
+    std::swap(m[6], m[9]);
+    std::swap(m[7], m[13]);
+    std::swap(m[11], m[14]);
+}
+
+constexpr std::array<float, 16> IdentityMatrix()
+{
+    return std::array<float, 16>{
+        1,
+        0,
+        0,
+        0,
+        0,
+        1,
+        0,
+        0,
+        0,
+        0,
+        1,
+        0,
+        0,
+        0,
+        0,
+        1,
+    };
+}
+
+inline std::array<float, 16> YawMatrix(float yawRadians)
+{
+    auto ys = (float)sin(yawRadians);
+    auto yc = (float)cos(yawRadians);
+    std::array<float, 16> yaw = {
+        yc,
+        0,
+        ys,
+        0,
+
+        0,
+        1,
+        0,
+        0,
+
+        -ys,
+        0,
+        yc,
+        0,
+
+        0,
+        0,
+        0,
+        1,
+    };
+    return yaw;
+}
+
+inline std::array<float, 16> PitchMatrix(float pitchRadians)
+{
+    auto ps = (float)sin(pitchRadians);
+    auto pc = (float)cos(pitchRadians);
+    std::array<float, 16> pitch = {
+        1,
+        0,
+        0,
+        0,
+
+        0,
+        pc,
+        ps,
+        0,
+
+        0,
+        -ps,
+        pc,
+        0,
+
+        0,
+        0,
+        0,
+        1,
+    };
+    return pitch;
+}
+
+constexpr std::array<float, 16> TranslationMatrix(float x, float y, float z)
+{
+    std::array<float, 16> t = {
+        1,
+        0,
+        0,
+        0,
+        0,
+        1,
+        0,
+        0,
+        0,
+        0,
+        1,
+        0,
+        x,
+        y,
+        z,
+        1,
+    };
+    return t;
+}
+
+inline double Cot(double value)
+{
+    return 1.0f / tan(value);
+}
+
+inline void PerspectiveRHGL(float projection[16], float fovYRadians, float aspectRatio, float zNear, float zFar)
+{
+    const float f = static_cast<float>(Cot(fovYRadians / 2.0));
+    projection[0] = f / aspectRatio;
+    projection[1] = 0.0f;
+    projection[2] = 0.0f;
+    projection[3] = 0.0f;
+
+    projection[4] = 0.0f;
+    projection[5] = f;
+    projection[6] = 0.0f;
+    projection[7] = 0.0f;
+
+    projection[8] = 0.0f;
+    projection[9] = 0.0f;
+    projection[10] = (zNear + zFar) / (zNear - zFar);
+    projection[11] = -1;
+
+    projection[12] = 0.0f;
+    projection[13] = 0.0f;
+    projection[14] = (2 * zFar * zNear) / (zNear - zFar);
+    projection[15] = 0.0f;
+}
+
+inline void PerspectiveRHDX(float projection[16], float fovYRadians, float aspectRatio, float zNear, float zFar)
+{
+    auto yScale = (float)Cot(fovYRadians / 2);
+    auto xScale = yScale / aspectRatio;
+    projection[0] = xScale;
+    projection[1] = 0.0f;
+    projection[2] = 0.0f;
+    projection[3] = 0.0f;
+
+    projection[4] = 0.0f;
+    projection[5] = yScale;
+    projection[6] = 0.0f;
+    projection[7] = 0.0f;
+
+    projection[8] = 0.0f;
+    projection[9] = 0.0f;
+    projection[10] = zFar / (zNear - zFar);
+    projection[11] = -1;
+
+    projection[12] = 0.0f;
+    projection[13] = 0.0f;
+    projection[14] = (zFar * zNear) / (zNear - zFar);
+    projection[15] = 0.0f;
+}
+
+///
+/// inverse
+///
+/// RowMatrixInverse: any invertible matrix
+/// RowMatrixAffineInverse: last column is (0, 0, 0, 1)
+/// RowMatrixRigidInverse: rotation and translation only
+///
+/// return false if the matrix is singular
+///
+
+// cofactor expansion. reference implementation
+inline bool RowMatrixInverseScalar(const std::array<float, 16> &m, std::array<float, 16> *out)
+{
+    std::array<float, 16> inv;
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    auto det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0)
+    {
+        return false;
+    }
+    auto f = 1.0f / det;
+    for (auto &v : inv)
+    {
+        v *= f;
+    }
+    *out = inv;
+    return true;
+}
+
+#if defined(FALG_SSE2)
+namespace detail
+{
+#define FALG_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+// 2x2 row major blocks stored as (m00, m01, m10, m11)
+// A * B
+inline __m128 mat2_mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, FALG_SHUFFLE(b, b, 0, 3, 0, 3)),
+                      _mm_mul_ps(FALG_SHUFFLE(a, a, 1, 0, 3, 2), FALG_SHUFFLE(b, b, 2, 1, 2, 1)));
+}
+// adjugate(A) * B
+inline __m128 mat2_adj_mul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(FALG_SHUFFLE(a, a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(FALG_SHUFFLE(a, a, 1, 1, 2, 2), FALG_SHUFFLE(b, b, 2, 3, 0, 1)));
+}
+// A * adjugate(B)
+inline __m128 mat2_mul_adj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, FALG_SHUFFLE(b, b, 3, 0, 3, 0)),
+                      _mm_mul_ps(FALG_SHUFFLE(a, a, 1, 0, 3, 2), FALG_SHUFFLE(b, b, 2, 1, 2, 1)));
+}
+} // namespace detail
+
+// 2x2 block matrix inverse
+inline bool RowMatrixInverseSSE2(const std::array<float, 16> &m, std::array<float, 16> *out)
+{
+    using namespace detail;
+    auto r0 = _mm_loadu_ps(&m[0]);
+    auto r1 = _mm_loadu_ps(&m[4]);
+    auto r2 = _mm_loadu_ps(&m[8]);
+    auto r3 = _mm_loadu_ps(&m[12]);
+
+    // | A B |
+    // | C D |
+    auto A = _mm_movelh_ps(r0, r1);
+    auto B = _mm_movehl_ps(r1, r0);
+    auto C = _mm_movelh_ps(r2, r3);
+    auto D = _mm_movehl_ps(r3, r2);
+
+    // (|A|, |B|, |C|, |D|)
+    auto detSub = _mm_sub_ps(
+        _mm_mul_ps(FALG_SHUFFLE(r0, r2, 0, 2, 0, 2), FALG_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(FALG_SHUFFLE(r0, r2, 1, 3, 1, 3), FALG_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    auto detA = FALG_SHUFFLE(detSub, detSub, 0, 0, 0, 0);
+    auto detB = FALG_SHUFFLE(detSub, detSub, 1, 1, 1, 1);
+    auto detC = FALG_SHUFFLE(detSub, detSub, 2, 2, 2, 2);
+    auto detD = FALG_SHUFFLE(detSub, detSub, 3, 3, 3, 3);
+
+    auto D_C = mat2_adj_mul(D, C);
+    auto A_B = mat2_adj_mul(A, B);
+    auto X_ = _mm_sub_ps(_mm_mul_ps(detD, A), mat2_mul(B, D_C));
+    auto W_ = _mm_sub_ps(_mm_mul_ps(detA, D), mat2_mul(C, A_B));
+    auto Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), mat2_mul_adj(D, A_B));
+    auto Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), mat2_mul_adj(A, D_C));
+
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    auto tr = _mm_mul_ps(A_B, FALG_SHUFFLE(D_C, D_C, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, FALG_SHUFFLE(tr, tr, 2, 3, 0, 1));
+    tr = _mm_add_ps(tr, FALG_SHUFFLE(tr, tr, 1, 0, 3, 2));
+    auto detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+    if (_mm_cvtss_f32(detM) == 0)
+    {
+        return false;
+    }
+
+    auto rDetM = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), detM);
+    X_ = _mm_mul_ps(X_, rDetM);
+    Y_ = _mm_mul_ps(Y_, rDetM);
+    Z_ = _mm_mul_ps(Z_, rDetM);
+    W_ = _mm_mul_ps(W_, rDetM);
+
+    // adjugate and store
+    _mm_storeu_ps(&(*out)[0], FALG_SHUFFLE(X_, Y_, 3, 1, 3, 1));
+    _mm_storeu_ps(&(*out)[4], FALG_SHUFFLE(X_, Y_, 2, 0, 2, 0));
+    _mm_storeu_ps(&(*out)[8], FALG_SHUFFLE(Z_, W_, 3, 1, 3, 1));
+    _mm_storeu_ps(&(*out)[12], FALG_SHUFFLE(Z_, W_, 2, 0, 2, 0));
+    return true;
+}
+// local to the inverse, not for the includers
+#undef FALG_SHUFFLE
+#endif
+
+inline bool RowMatrixInverse(const std::array<float, 16> &m, std::array<float, 16> *out)
+{
+#if defined(FALG_SSE2)
+    return RowMatrixInverseSSE2(m, out);
+#else
+    return RowMatrixInverseScalar(m, out);
+#endif
+}
+
+// | A 0 |
+// | t 1 |
+constexpr bool RowMatrixAffineInverse(const std::array<float, 16> &m, std::array<float, 16> *out)
+{
+    // cofactors of the 3x3 part
+    auto c00 = m[5] * m[10] - m[6] * m[9];
+    auto c01 = m[6] * m[8] - m[4] * m[10];
+    auto c02 = m[4] * m[9] - m[5] * m[8];
+    auto det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+    if (det == 0)
+    {
+        return false;
+    }
+    auto f = 1.0f / det;
+    std::array<float, 16> inv{
+        c00 * f,
+        (m[2] * m[9] - m[1] * m[10]) * f,
+        (m[1] * m[6] - m[2] * m[5]) * f,
+        0,
+        c01 * f,
+        (m[0] * m[10] - m[2] * m[8]) * f,
+        (m[2] * m[4] - m[0] * m[6]) * f,
+        0,
+        c02 * f,
+        (m[1] * m[8] - m[0] * m[9]) * f,
+        (m[0] * m[5] - m[1] * m[4]) * f,
+        0,
+        0,
+        0,
+        0,
+        1,
+    };
+    // -t * A^-1
+    for (int i = 0; i < 3; ++i)
+    {
+        inv[12 + i] = -(m[12] * inv[i] + m[13] * inv[4 + i] + m[14] * inv[8 + i]);
+    }
+    *out = inv;
+    return true;
+}
+
+// | R 0 |
+// | t 1 | R is orthonormal
+constexpr std::array<float, 16> RowMatrixRigidInverse(const std::array<float, 16> &m)
+{
+    std::array<float, 16> inv{
+        m[0], m[4], m[8], 0,
+        m[1], m[5], m[9], 0,
+        m[2], m[6], m[10], 0,
+        0, 0, 0, 1};
+    for (int i = 0; i < 3; ++i)
+    {
+        inv[12 + i] = -(m[12] * inv[i] + m[13] * inv[4 + i] + m[14] * inv[8 + i]);
+    }
+    return inv;
+}
+
+// normal matrix. transpose(inverse(A)) of the 3x3 part, no translation
+constexpr bool RowMatrixInverseTranspose(const std::array<float, 16> &m, std::array<float, 16> *out)
+{
+    std::array<float, 16> inv{};
+    if (!RowMatrixAffineInverse(m, &inv))
+    {
+        return false;
+    }
+    inv[12] = inv[13] = inv[14] = 0;
+    Transpose(inv);
+    *out = inv;
+    return true;
+}
+
+inline float4 QuaternionAxisAngle(const float3 &axis, float angle)
+{
+    auto angle_half = angle / 2;
+    auto sin = std::sin(angle_half);
+    auto cos = std::cos(angle_half);
+    return {axis[0] * sin, axis[1] * sin, axis[2] * sin, cos};
+}
+
+// inline float4 QuaternionMul(const float4 &lhs, const float4 &rhs)
+// {
+//     return {lhs[0] * rhs[3] + lhs[3] * rhs[0] + lhs[1] * rhs[2] - lhs[2] * rhs[1],
+//             lhs[1] * rhs[3] + lhs[3] * rhs[1] + lhs[2] * rhs[0] - lhs[0] * rhs[2],
+//             lhs[2] * rhs[3] + lhs[3] * rhs[2] + lhs[0] * rhs[1] - lhs[1] * rhs[0],
+//             lhs[3] * rhs[3] - lhs[0] * rhs[0] - lhs[1] * rhs[1] - lhs[2] * rhs[2]};
+// }
+template <typename T>
+constexpr float4 QuaternionMul(const T &l, T r)
+{
+    if (Dot(l, r) < 0)
+    {
+        r = {-r[0], -r[1], -r[2], -r[3]};
+    }
+    auto lhs = float_array<T>::load(l);
+    auto rhs = float_array<T>::load(r);
+    return {rhs[0] * lhs[3] + rhs[3] * lhs[0] + rhs[1] * lhs[2] - rhs[2] * lhs[1],
+            rhs[1] * lhs[3] + rhs[3] * lhs[1] + rhs[2] * lhs[0] - rhs[0] * lhs[2],
+            rhs[2] * lhs[3] + rhs[3] * lhs[2] + rhs[0] * lhs[1] - rhs[1] * lhs[0],
+            rhs[3] * lhs[3] - rhs[0] * lhs[0] - rhs[1] * lhs[1] - rhs[2] * lhs[2]};
+}
+// inline float4 operator*(const float4 &lhs, const float4 &rhs)
+// {
+//     float ax = lhs[0];
+//     float ay = lhs[1];
+//     float az = lhs[2];
+//     float aw = lhs[3];
+//     float bx = rhs[0];
+//     float by = rhs[1];
+//     float bz = rhs[2];
+//     float bw = rhs[3];
+//     return {
+//         ax * bw + aw * bx + ay * bz - az * by,
+//         ay * bw + aw * by + az * bx - ax * bz,
+//         az * bw + aw * bz + ax * by - ay * bx,
+//         aw * bw - ax * bx - ay * by - az * bz,
+//     };
+// }
+
+constexpr float4 QuaternionConjugate(const float4 &v)
+{
+    return {-v[0], -v[1], -v[2], v[3]};
+}
+
+constexpr float3 QuaternionXDir(const float4 &v)
+{
+    auto x = v[0];
+    auto y = v[1];
+    auto z = v[2];
+    auto w = v[3];
+    return {w * w + x * x - y * y - z * z, (x * y + z * w) * 2, (z * x - y * w) * 2};
+}
+
+constexpr float3 QuaternionYDir(const float4 &v)
+{
+    auto x = v[0];
+    auto y = v[1];
+    auto z = v[2];
+    auto w = v[3];
+    return {(x * y - z * w) * 2, w * w - x * x + y * y - z * z, (y * z + x * w) * 2};
+}
+
+constexpr float3 QuaternionZDir(const float4 &v)
+{
+    auto x = v[0];
+    auto y = v[1];
+    auto z = v[2];
+    auto w = v[3];
+    return {(z * x + y * w) * 2, (y * z - x * w) * 2, w * w - x * x - y * y + z * z};
+}
+
+constexpr std::array<float, 16> QuaternionMatrix(const float4 &q)
+{
+    auto x = QuaternionXDir(q);
+    auto y = QuaternionYDir(q);
+    auto z = QuaternionZDir(q);
+    return {
+        x[0], x[1], x[2], 0,
+        y[0], y[1], y[2], 0,
+        z[0], z[1], z[2], 0,
+        0, 0, 0, 1};
+}
+
+constexpr std::array<float, 16> ScaleMatrix(const float3 &s)
+{
+    return {
+        s[0], 0, 0, 0,
+        0, s[1], 0, 0,
+        0, 0, s[2], 0,
+        0, 0, 0, 1};
+}
+
+constexpr std::array<float, 16> ScaleMatrix(float x, float y, float z)
+{
+    return ScaleMatrix({x, y, z});
+}
+
+constexpr float3 QuaternionRotateFloat3(const float4 &q, const float3 &v)
+{
+    return LinearCombination(QuaternionXDir(q), v[0], QuaternionYDir(q), v[1], QuaternionZDir(q), v[2]);
+}
+
+///
+/// batch
+///
+/// transform many points with one basis.
+/// the quaternion axes are computed once, not per point.
+///
+template <typename F>
+struct xyz_span
+{
+    std::span<F> x;
+    std::span<F> y;
+    std::span<F> z;
+
+    size_t size() const
+    {
+        return x.size();
+    }
+
+    operator xyz_span<const F>() const
+        requires(!std::is_const_v<F>)
+    {
+        return {x, y, z};
+    }
+};
+
+struct AffineBasis
+{
+    float3 x;
+    float3 y;
+    float3 z;
+    float3 t;
+
+    // same operation order as Transform::ApplyPosition
+    constexpr float3 ApplyPosition(const float3 &v) const
+    {
+        return {
+            (x[0] * v[0] + (y[0] * v[1] + z[0] * v[2])) + t[0],
+            (x[1] * v[0] + (y[1] * v[1] + z[1] * v[2])) + t[1],
+            (x[2] * v[0] + (y[2] * v[1] + z[2] * v[2])) + t[2],
+        };
+    }
+
+    constexpr float3 ApplyDirection(const float3 &v) const
+    {
+        return {
+            x[0] * v[0] + (y[0] * v[1] + z[0] * v[2]),
+            x[1] * v[0] + (y[1] * v[1] + z[1] * v[2]),
+            x[2] * v[0] + (y[2] * v[1] + z[2] * v[2]),
+        };
+    }
+};
+
+#if defined(FALG_SSE2)
+namespace detail
+{
+struct sse_basis
+{
+    __m128 x;
+    __m128 y;
+    __m128 z;
+    __m128 t;
+
+    sse_basis(const AffineBasis &b)
+        : x(_mm_setr_ps(b.x[0], b.x[1], b.x[2], 0)),
+          y(_mm_setr_ps(b.y[0], b.y[1], b.y[2], 0)),
+          z(_mm_setr_ps(b.z[0], b.z[1], b.z[2], 0)),
+          t(_mm_setr_ps(b.t[0], b.t[1], b.t[2], 0))
+    {
+    }
+
+    __m128 direction(const float3 &v) const
+    {
+        return _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(v[0])),
+                          _mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(v[1])), _mm_mul_ps(z, _mm_set1_ps(v[2]))));
+    }
+
+    __m128 position(const float3 &v) const
+    {
+        return _mm_add_ps(direction(v), t);
+    }
+};
+
+inline void store3(float3 &dst, __m128 v)
+{
+    _mm_storel_pi((__m64 *)&dst[0], v);
+    _mm_store_ss(&dst[2], _mm_movehl_ps(v, v));
+}
+} // namespace detail
+#endif
+
+inline void BatchApplyPositions(const AffineBasis &b, std::span<const float3> src, std::span<float3> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    detail::sse_basis m(b);
+    for (; i < src.size(); ++i)
+    {
+        detail::store3(dst[i], m.position(src[i]));
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = b.ApplyPosition(src[i]);
+    }
+}
+
+inline void BatchApplyDirections(const AffineBasis &b, std::span<const float3> src, std::span<float3> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    detail::sse_basis m(b);
+    for (; i < src.size(); ++i)
+    {
+        detail::store3(dst[i], m.direction(src[i]));
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = b.ApplyDirection(src[i]);
+    }
+}
+
+// SoA. 4 points per iteration
+inline void BatchApplyPositions(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    for (; i + 4 <= src.size(); i += 4)
+    {
+        auto x = _mm_loadu_ps(&src.x[i]);
+        auto y = _mm_loadu_ps(&src.y[i]);
+        auto z = _mm_loadu_ps(&src.z[i]);
+        float *out[] = {&dst.x[i], &dst.y[i], &dst.z[i]};
+        for (int j = 0; j < 3; ++j)
+        {
+            auto v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b.x[j]), x),
+                                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b.y[j]), y), _mm_mul_ps(_mm_set1_ps(b.z[j]), z)));
+            _mm_storeu_ps(out[j], _mm_add_ps(v, _mm_set1_ps(b.t[j])));
+        }
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        auto v = b.ApplyPosition({src.x[i], src.y[i], src.z[i]});
+        dst.x[i] = v[0];
+        dst.y[i] = v[1];
+        dst.z[i] = v[2];
+    }
+}
+
+inline void BatchApplyDirections(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    for (; i + 4 <= src.size(); i += 4)
+    {
+        auto x = _mm_loadu_ps(&src.x[i]);
+        auto y = _mm_loadu_ps(&src.y[i]);
+        auto z = _mm_loadu_ps(&src.z[i]);
+        float *out[] = {&dst.x[i], &dst.y[i], &dst.z[i]};
+        for (int j = 0; j < 3; ++j)
+        {
+            auto v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b.x[j]), x),
+                                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b.y[j]), y), _mm_mul_ps(_mm_set1_ps(b.z[j]), z)));
+            _mm_storeu_ps(out[j], v);
+        }
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        auto v = b.ApplyDirection({src.x[i], src.y[i], src.z[i]});
+        dst.x[i] = v[0];
+        dst.y[i] = v[1];
+        dst.z[i] = v[2];
+    }
+}
+
+// interleaved vertices. copy src to dst and transform position and normal members
+template <typename V>
+inline void BatchApplyVertices(const AffineBasis &b, std::span<const V> src, std::span<V> dst,
+                               float3 V::*position, float3 V::*normal)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    detail::sse_basis m(b);
+    for (; i < src.size(); ++i)
+    {
+        auto p = m.position(src[i].*position);
+        auto n = m.direction(src[i].*normal);
+        dst[i] = src[i];
+        detail::store3(dst[i].*position, p);
+        detail::store3(dst[i].*normal, n);
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = src[i];
+        dst[i].*position = b.ApplyPosition(src[i].*position);
+        dst[i].*normal = b.ApplyDirection(src[i].*normal);
+    }
+}
+
+struct Transform
+{
+    float3 translation{0, 0, 0};
+    float4 rotation{0, 0, 0, 1};
+
+    constexpr Transform operator*(const Transform &rhs) const
+    {
+        return {
+            rhs.ApplyPosition(translation),
+            QuaternionMul(rotation, rhs.rotation)};
+    }
+
+    constexpr std::array<float, 16> RowMatrix() const
+    {
+        auto r = QuaternionMatrix(rotation);
+        r[12] = translation[0];
+        r[13] = translation[1];
+        r[14] = translation[2];
+        return r;
+    }
+
+    constexpr Transform Inverse() const
+    {
+        auto inv_r = QuaternionConjugate(rotation);
+        auto inv_t = QuaternionRotateFloat3(inv_r, MulScalar(translation, -1));
+        return {inv_t, inv_r};
+    }
+
+    constexpr float3 ApplyPosition(const float3 &v) const
+    {
+        return Basis().ApplyPosition(v);
+    }
+
+    constexpr float3 ApplyDirection(const float3 &v) const
+    {
+        return QuaternionRotateFloat3(rotation, v);
+    }
+
+    constexpr AffineBasis Basis() const
+    {
+        return {
+            QuaternionXDir(rotation),
+            QuaternionYDir(rotation),
+            QuaternionZDir(rotation),
+            translation,
+        };
+    }
+
+    void ApplyPositions(std::span<const float3> src, std::span<float3> dst) const
+    {
+        BatchApplyPositions(Basis(), src, dst);
+    }
+
+    void ApplyPositions(xyz_span<const float> src, xyz_span<float> dst) const
+    {
+        BatchApplyPositions(Basis(), src, dst);
+    }
+
+    void ApplyDirections(std::span<const float3> src, std::span<float3> dst) const
+    {
+        BatchApplyDirections(Basis(), src, dst);
+    }
+
+    void ApplyDirections(xyz_span<const float> src, xyz_span<float> dst) const
+    {
+        BatchApplyDirections(Basis(), src, dst);
+    }
+};
+
+struct TRS
+{
+    union {
+        Transform transform;
+        struct
+        {
+            float3 translation;
+            float4 rotation;
+        };
+    };
+    float3 scale;
+
+    constexpr TRS()
+        : translation({0, 0, 0}), rotation({0, 0, 0, 1}), scale({1, 1, 1})
+    {
+    }
+
+    constexpr TRS(const float3 &t, const float4 &r, const float3 &s)
+        : translation(t), rotation(r), scale(s)
+    {
+    }
+
+    // ScaleMatrix(scale) * Transform{translation, rotation}.RowMatrix() without the 4x4 multiply
+    constexpr std::array<float, 16> RowMatrix() const
+    {
+        auto b = Basis();
+        return {
+            b.x[0], b.x[1], b.x[2], 0,
+            b.y[0], b.y[1], b.y[2], 0,
+            b.z[0], b.z[1], b.z[2], 0,
+            b.t[0], b.t[1], b.t[2], 1};
+    }
+
+    // scale is folded into the axes. ApplyDirection of this basis does not keep normals perpendicular
+    constexpr AffineBasis Basis() const
+    {
+        return {
+            MulScalar(QuaternionXDir(rotation), scale[0]),
+            MulScalar(QuaternionYDir(rotation), scale[1]),
+            MulScalar(QuaternionZDir(rotation), scale[2]),
+            translation,
+        };
+    }
+
+    void ApplyPositions(std::span<const float3> src, std::span<float3> dst) const
+    {
+        BatchApplyPositions(Basis(), src, dst);
+    }
+
+    void ApplyPositions(xyz_span<const float> src, xyz_span<float> dst) const
+    {
+        BatchApplyPositions(Basis(), src, dst);
+    }
+};
+static_assert(sizeof(TRS) == 40, "TRS");
+
+// constant expressions
+static_assert(RowMatrixMul(IdentityMatrix(), TranslationMatrix(1, 2, 3)) == TranslationMatrix(1, 2, 3), "RowMatrixMul");
+static_assert(QuaternionRotateFloat3({0, 0, 1, 0}, {1, 2, 3}) == float3{-1, -2, 3}, "QuaternionRotateFloat3");
+static_assert(QuaternionMatrix({0, 0, 1, 0}) == ScaleMatrix(-1, -1, 1), "QuaternionMatrix");
+static_assert(Transform{{1, 2, 3}, {0, 0, 1, 0}}.Inverse().ApplyPosition({1, 2, 3}) == float3{0, 0, 0}, "Transform::Inverse");
+static_assert((Transform{{1, 0, 0}, {0, 0, 1, 0}} * Transform{{0, 1, 0}, {0, 0, 0, 1}}).translation == float3{1, 1, 0}, "Transform::operator*");
+static_assert(TRS({1, 2, 3}, {0, 0, 1, 0}, {2, 2, 2}).RowMatrix() == float16{-2, 0, 0, 0, 0, -2, 0, 0, 0, 0, 2, 0, 1, 2, 3, 1}, "TRS::RowMatrix");
+static_assert(LinearCombination(float3{1, 0, 0}, 2.0f, float3{0, 1, 0}, 3.0f, float3{0, 0, 1}, 4.0f) == float3{2, 3, 4}, "LinearCombination");
+static_assert(MulAdd(float4{1, 2, 3, 4}, 2.0f, float4{1, 1, 1, 1}) == float4{3, 5, 7, 9}, "MulAdd");
+
+struct Ray
+{
+    float3 origin;
+    float3 direction;
+
+    constexpr Ray(const float3 &_origin, const float3 &_direction)
+        : origin(_origin), direction(_direction)
+    {
+    }
+
+    template <typename T>
+    Ray(const T &t)
+    {
+        static_assert(sizeof(T) == sizeof(Ray), "Ray::Ray()");
+        auto &ray = size_cast<Ray>(t);
+        origin = ray.origin;
+        direction = ray.direction;
+    }
+
+    Ray ToLocal(const falg::Transform &t) const
+    {
+        auto toLocal = t.Inverse();
+        return {
+            toLocal.ApplyPosition(origin),
+            falg::QuaternionRotateFloat3(toLocal.rotation, direction)};
+    }
+
+    constexpr float3 SetT(float t) const
+    {
+        return MulAdd(direction, t, origin);
+    }
+
+    Ray Transform(const falg::Transform &t) const
+    {
+        return {
+            t.ApplyPosition(origin),
+            t.ApplyDirection(direction),
+        };
+    }
+};
+
+struct Plane
+{
+    float3 normal;
+    float3 pointOnPlane;
+
+    constexpr Plane(const float3 &n, const float3 &point_on_plane)
+        : normal(n), pointOnPlane(point_on_plane)
+    {
+    }
+};
+
+inline float operator>>(const Ray &ray, const Plane &plane)
+{
+    auto NV = Dot(plane.normal, ray.direction);
+    if (NV == 0)
+    {
+        // not intersect
+        return -std::numeric_limits<float>::infinity();
+    }
+
+    auto Q = Sub(plane.pointOnPlane, ray.origin);
+    auto NQ = Dot(plane.normal, Q);
+    return NQ / NV;
+}
+
+struct Triangle
+{
+    float3 v0;
+    float3 v1;
+    float3 v2;
+};
+
+// float intersect_ray_triangle(const ray &ray, const minalg::float3 &v0, const minalg::float3 &v1, const minalg::float3 &v2)
+// u, v are the barycentric weights of v1 and v2. hit point = v0 + u * (v1 - v0) + v * (v2 - v0)
+inline float IntersectTriangle(const Ray &ray, const Triangle &triangle, float &u, float &v)
+{
+    auto e1 = Sub(triangle.v1, triangle.v0);
+    auto e2 = Sub(triangle.v2, triangle.v0);
+    auto h = Cross(ray.direction, e2);
+    auto a = Dot(e1, h);
+    if (std::abs(a) == 0)
+        return std::numeric_limits<float>::infinity();
+
+    float f = 1 / a;
+    auto s = Sub(ray.origin, triangle.v0);
+    u = f * Dot(s, h);
+    if (u < 0 || u > 1)
+        return std::numeric_limits<float>::infinity();
+
+    auto q = Cross(s, e1);
+    v = f * Dot(ray.direction, q);
+    if (v < 0 || u + v > 1)
+        return std::numeric_limits<float>::infinity();
+
+    auto t = f * Dot(e2, q);
+    if (t < 0)
+        return std::numeric_limits<float>::infinity();
+
+    return t;
+}
+
+inline float operator>>(const Ray &ray, const Triangle &triangle)
+{
+    float u = 0;
+    float v = 0;
+    return IntersectTriangle(ray, triangle, u, v);
+}
+
+///
+/// triangle packets
+///
+/// triangles in SoA blocks of 8 for SIMD ray intersection.
+/// unused lanes have zero edges and never hit.
+///
+struct TrianglePacket
+{
+    static const size_t WIDTH = 8;
+
+    float v0x[WIDTH];
+    float v0y[WIDTH];
+    float v0z[WIDTH];
+    float e1x[WIDTH];
+    float e1y[WIDTH];
+    float e1z[WIDTH];
+    float e2x[WIDTH];
+    float e2y[WIDTH];
+    float e2z[WIDTH];
+};
+
+struct RayHit
+{
+    float t = std::numeric_limits<float>::infinity();
+    // index of the triangle. lane + packet * TrianglePacket::WIDTH. (max) for the windows.h macro
+    uint32_t triangle = (std::numeric_limits<uint32_t>::max)();
+
+    bool IsHit() const
+    {
+        return triangle != (std::numeric_limits<uint32_t>::max)();
+    }
+};
+
+// positions are gathered by indices (3 per triangle)
+template <typename V>
+inline std::vector<TrianglePacket> BuildTrianglePackets(std::span<const V> vertices, std::span<const uint32_t> indices, float3 V::*position)
+{
+    auto count = indices.size() / 3;
+    std::vector<TrianglePacket> packets((count + TrianglePacket::WIDTH - 1) / TrianglePacket::WIDTH, TrianglePacket{});
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto &v0 = vertices[indices[i * 3]].*position;
+        auto &v1 = vertices[indices[i * 3 + 1]].*position;
+        auto &v2 = vertices[indices[i * 3 + 2]].*position;
+        auto e1 = Sub(v1, v0);
+        auto e2 = Sub(v2, v0);
+        auto &p = packets[i / TrianglePacket::WIDTH];
+        auto lane = i % TrianglePacket::WIDTH;
+        p.v0x[lane] = v0[0];
+        p.v0y[lane] = v0[1];
+        p.v0z[lane] = v0[2];
+        p.e1x[lane] = e1[0];
+        p.e1y[lane] = e1[1];
+        p.e1z[lane] = e1[2];
+        p.e2x[lane] = e2[0];
+        p.e2y[lane] = e2[1];
+        p.e2z[lane] = e2[2];
+    }
+    return packets;
+}
+
+// same arithmetic as operator>>(Ray, Triangle) for one lane
+inline float IntersectTrianglePacketLane(const Ray &ray, const TrianglePacket &p, size_t lane)
+{
+    float3 e1{p.e1x[lane], p.e1y[lane], p.e1z[lane]};
+    float3 e2{p.e2x[lane], p.e2y[lane], p.e2z[lane]};
+    auto h = Cross(ray.direction, e2);
+    auto a = Dot(e1, h);
+    if (std::abs(a) == 0)
+        return std::numeric_limits<float>::infinity();
+
+    float f = 1 / a;
+    auto s = Sub(ray.origin, float3{p.v0x[lane], p.v0y[lane], p.v0z[lane]});
+    auto u = f * Dot(s, h);
+    if (u < 0 || u > 1)
+        return std::numeric_limits<float>::infinity();
+
+    auto q = Cross(s, e1);
+    auto v = f * Dot(ray.direction, q);
+    if (v < 0 || u + v > 1)
+        return std::numeric_limits<float>::infinity();
+
+    auto t = f * Dot(e2, q);
+    if (t < 0)
+        return std::numeric_limits<float>::infinity();
+
+    return t;
+}
+
+inline RayHit IntersectTrianglePacketsScalar(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+    RayHit hit;
+    for (size_t i = 0; i < packets.size(); ++i)
+    {
+        for (size_t lane = 0; lane < TrianglePacket::WIDTH; ++lane)
+        {
+            auto t = IntersectTrianglePacketLane(ray, packets[i], lane);
+            if (t < hit.t)
+            {
+                hit.t = t;
+                hit.triangle = static_cast<uint32_t>(i * TrianglePacket::WIDTH + lane);
+            }
+        }
+    }
+    return hit;
+}
+
+#if defined(FALG_SSE2)
+// each packet as two halves of 4 lanes
+inline RayHit IntersectTrianglePacketsSSE2(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+    auto dx = _mm_set1_ps(ray.direction[0]);
+    auto dy = _mm_set1_ps(ray.direction[1]);
+    auto dz = _mm_set1_ps(ray.direction[2]);
+    auto ox = _mm_set1_ps(ray.origin[0]);
+    auto oy = _mm_set1_ps(ray.origin[1]);
+    auto oz = _mm_set1_ps(ray.origin[2]);
+    auto zero = _mm_setzero_ps();
+    auto one = _mm_set1_ps(1.0f);
+    auto inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+
+    // per lane nearest
+    auto best_t = inf;
+    auto best_id = _mm_set1_epi32(-1);
+    auto id = _mm_setr_epi32(0, 1, 2, 3);
+    auto step = _mm_set1_epi32(4);
+    for (auto &p : packets)
+    {
+        for (size_t o = 0; o < TrianglePacket::WIDTH; o += 4)
+        {
+            auto e1x = _mm_loadu_ps(p.e1x + o);
+            auto e1y = _mm_loadu_ps(p.e1y + o);
+            auto e1z = _mm_loadu_ps(p.e1z + o);
+            auto e2x = _mm_loadu_ps(p.e2x + o);
+            auto e2y = _mm_loadu_ps(p.e2y + o);
+            auto e2z = _mm_loadu_ps(p.e2z + o);
+            // h = d x e2
+            auto hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+            auto hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+            auto hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+            auto a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)), _mm_mul_ps(e1z, hz));
+            auto f = _mm_div_ps(one, a);
+            // s = o - v0
+            auto sx = _mm_sub_ps(ox, _mm_loadu_ps(p.v0x + o));
+            auto sy = _mm_sub_ps(oy, _mm_loadu_ps(p.v0y + o));
+            auto sz = _mm_sub_ps(oz, _mm_loadu_ps(p.v0z + o));
+            auto u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)), _mm_mul_ps(sz, hz)));
+            // q = s x e1
+            auto qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+            auto qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+            auto qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+            auto v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+            auto t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+
+            // a != 0 && 0 <= u <= 1 && 0 <= v && u + v <= 1 && 0 <= t < best_t
+            auto ok = _mm_cmpneq_ps(a, zero);
+            ok = _mm_and_ps(ok, _mm_cmpge_ps(u, zero));
+            ok = _mm_and_ps(ok, _mm_cmple_ps(u, one));
+            ok = _mm_and_ps(ok, _mm_cmpge_ps(v, zero));
+            ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_add_ps(u, v), one));
+            ok = _mm_and_ps(ok, _mm_cmpge_ps(t, zero));
+            ok = _mm_and_ps(ok, _mm_cmplt_ps(t, best_t));
+            best_t = _mm_or_ps(_mm_and_ps(ok, t), _mm_andnot_ps(ok, best_t));
+            auto oki = _mm_castps_si128(ok);
+            best_id = _mm_or_si128(_mm_and_si128(oki, id), _mm_andnot_si128(oki, best_id));
+            id = _mm_add_epi32(id, step);
+        }
+    }
+
+    alignas(16) float ts[4];
+    alignas(16) uint32_t ids[4];
+    _mm_store_ps(ts, best_t);
+    _mm_store_si128((__m128i *)ids, best_id);
+    // nearest, first triangle on a tie like the scalar loop
+    RayHit hit;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (ts[i] < hit.t || (ts[i] == hit.t && ids[i] < hit.triangle))
+        {
+            hit.t = ts[i];
+            hit.triangle = ids[i];
+        }
+    }
+    return hit;
+}
+#endif
+
+#if defined(FALG_SSE2)
+FALG_TARGET("avx") inline RayHit IntersectTrianglePacketsAVX(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+    auto dx = _mm256_set1_ps(ray.direction[0]);
+    auto dy = _mm256_set1_ps(ray.direction[1]);
+    auto dz = _mm256_set1_ps(ray.direction[2]);
+    auto ox = _mm256_set1_ps(ray.origin[0]);
+    auto oy = _mm256_set1_ps(ray.origin[1]);
+    auto oz = _mm256_set1_ps(ray.origin[2]);
+    auto zero = _mm256_setzero_ps();
+    auto one = _mm256_set1_ps(1.0f);
+
+    auto best_t = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    // packet index per lane. float is exact up to 2^24 packets
+    auto best_packet = _mm256_set1_ps(-1);
+    auto packet = zero;
+    for (auto &p : packets)
+    {
+        auto e1x = _mm256_loadu_ps(p.e1x);
+        auto e1y = _mm256_loadu_ps(p.e1y);
+        auto e1z = _mm256_loadu_ps(p.e1z);
+        auto e2x = _mm256_loadu_ps(p.e2x);
+        auto e2y = _mm256_loadu_ps(p.e2y);
+        auto e2z = _mm256_loadu_ps(p.e2z);
+        auto hx = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+        auto hy = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+        auto hz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+        auto a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, hx), _mm256_mul_ps(e1y, hy)), _mm256_mul_ps(e1z, hz));
+        auto f = _mm256_div_ps(one, a);
+        auto sx = _mm256_sub_ps(ox, _mm256_loadu_ps(p.v0x));
+        auto sy = _mm256_sub_ps(oy, _mm256_loadu_ps(p.v0y));
+        auto sz = _mm256_sub_ps(oz, _mm256_loadu_ps(p.v0z));
+        auto u = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, hx), _mm256_mul_ps(sy, hy)), _mm256_mul_ps(sz, hz)));
+        auto qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+        auto qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+        auto qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+        auto v = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)));
+        auto t = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)));
+
+        auto ok = _mm256_cmp_ps(a, zero, _CMP_NEQ_UQ);
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(t, best_t, _CMP_LT_OQ));
+        best_t = _mm256_blendv_ps(best_t, t, ok);
+        best_packet = _mm256_blendv_ps(best_packet, packet, ok);
+        packet = _mm256_add_ps(packet, one);
+    }
+
+    alignas(32) float ts[8];
+    alignas(32) float ps[8];
+    _mm256_store_ps(ts, best_t);
+    _mm256_store_ps(ps, best_packet);
+    RayHit hit;
+    for (uint32_t lane = 0; lane < 8; ++lane)
+    {
+        if (ps[lane] < 0)
+        {
+            continue;
+        }
+        auto triangle = static_cast<uint32_t>(ps[lane]) * 8 + lane;
+        if (ts[lane] < hit.t || (ts[lane] == hit.t && triangle < hit.triangle))
+        {
+            hit.t = ts[lane];
+            hit.triangle = triangle;
+        }
+    }
+    return hit;
+}
+#endif
+
+// nearest hit of the ray
+inline RayHit IntersectTrianglePackets(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+#if defined(FALG_AVX)
+    return IntersectTrianglePacketsAVX(ray, packets);
+#elif defined(FALG_SSE2)
+    return IntersectTrianglePacketsSSE2(ray, packets);
+#else
+    return IntersectTrianglePacketsScalar(ray, packets);
+#endif
+}
+
+///
+/// project / unproject
+///
+/// screen: x, y in pixels from the viewport top-left, z is the clip space depth
+///
+struct Viewport
+{
+    float x = 0;
+    float y = 0;
+    float width = 1;
+    float height = 1;
+};
+
+// [p, 1] * m, divided by w
+inline float3 RowMatrixApplyPerspective(const std::array<float, 16> &m, const float3 &p)
+{
+    auto x = p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12];
+    auto y = p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13];
+    auto z = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14];
+    auto w = p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + m[15];
+    return {x / w, y / w, z / w};
+}
+
+inline float3 Project(const std::array<float, 16> &viewProjection, const Viewport &viewport, const float3 &world)
+{
+    auto ndc = RowMatrixApplyPerspective(viewProjection, world);
+    return {
+        viewport.x + (ndc[0] + 1) * 0.5f * viewport.width,
+        viewport.y + (1 - ndc[1]) * 0.5f * viewport.height,
+        ndc[2],
+    };
+}
+
+inline float3 Unproject(const std::array<float, 16> &inverseViewProjection, const Viewport &viewport, const float3 &screen)
+{
+    return RowMatrixApplyPerspective(inverseViewProjection, {
+                                                                (screen[0] - viewport.x) / viewport.width * 2 - 1,
+                                                                1 - (screen[1] - viewport.y) / viewport.height * 2,
+                                                                screen[2],
+                                                            });
+}
+
+#if defined(FALG_SSE2)
+namespace detail
+{
+inline void apply_perspective(__m128 r0, __m128 r1, __m128 r2, __m128 r3, const float3 &p, float3 &dst)
+{
+    auto v = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), r0), _mm_mul_ps(_mm_set1_ps(p[1]), r1)),
+                                   _mm_mul_ps(_mm_set1_ps(p[2]), r2)),
+                        r3);
+    store3(dst, _mm_div_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+} // namespace detail
+#endif
+
+// batch versions. the matrix rows are loaded once
+inline void Project(const std::array<float, 16> &viewProjection, const Viewport &viewport,
+                    std::span<const float3> world, std::span<float3> screen)
+{
+    // fold the viewport transform into the matrix: vx + (x / w + 1) * width / 2 = (x * width / 2 + w * (vx + width / 2)) / w
+    auto m = viewProjection;
+    auto sx = viewport.width * 0.5f;
+    auto sy = -viewport.height * 0.5f;
+    auto ox = viewport.x + viewport.width * 0.5f;
+    auto oy = viewport.y + viewport.height * 0.5f;
+    for (int i = 0; i < 16; i += 4)
+    {
+        m[i] = m[i] * sx + m[i + 3] * ox;
+        m[i + 1] = m[i + 1] * sy + m[i + 3] * oy;
+    }
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    auto r0 = _mm_loadu_ps(&m[0]);
+    auto r1 = _mm_loadu_ps(&m[4]);
+    auto r2 = _mm_loadu_ps(&m[8]);
+    auto r3 = _mm_loadu_ps(&m[12]);
+    for (; i < world.size(); ++i)
+    {
+        detail::apply_perspective(r0, r1, r2, r3, world[i], screen[i]);
+    }
+#endif
+    for (; i < world.size(); ++i)
+    {
+        screen[i] = RowMatrixApplyPerspective(m, world[i]);
+    }
+}
+
+inline void Unproject(const std::array<float, 16> &inverseViewProjection, const Viewport &viewport,
+                      std::span<const float3> screen, std::span<float3> world)
+{
+    // fold the screen to ndc transform into the matrix
+    auto sx = 2 / viewport.width;
+    auto sy = -2 / viewport.height;
+    auto ox = -viewport.x * sx - 1;
+    auto oy = -viewport.y * sy + 1;
+    auto m = inverseViewProjection;
+    for (int j = 0; j < 4; ++j)
+    {
+        m[12 + j] += m[j] * ox + m[4 + j] * oy;
+        m[j] *= sx;
+        m[4 + j] *= sy;
+    }
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    auto r0 = _mm_loadu_ps(&m[0]);
+    auto r1 = _mm_loadu_ps(&m[4]);
+    auto r2 = _mm_loadu_ps(&m[8]);
+    auto r3 = _mm_loadu_ps(&m[12]);
+    for (; i < screen.size(); ++i)
+    {
+        detail::apply_perspective(r0, r1, r2, r3, screen[i], world[i]);
+    }
+#endif
+    for (; i < screen.size(); ++i)
+    {
+        world[i] = RowMatrixApplyPerspective(m, screen[i]);
+    }
+}
+
+// ray from the near plane to the far plane through the screen point.
+// nearZ is 0 for PerspectiveRHDX, -1 for PerspectiveRHGL
+inline Ray ScreenRay(const std::array<float, 16> &inverseViewProjection, const Viewport &viewport,
+                     float x, float y, float nearZ = 0)
+{
+    auto n = Unproject(inverseViewProjection, viewport, {x, y, nearZ});
+    auto f = Unproject(inverseViewProjection, viewport, {x, y, 1});
+    return {n, Normalize(Sub(f, n))};
+}
+
+///
+/// frustum
+///
+enum class ClipDepth
+{
+    // PerspectiveRHDX
+    ZeroToOne,
+    // PerspectiveRHGL
+    MinusOneToOne,
+};
+
+// bounds in SoA. one box or sphere per index
+struct aabb_span
+{
+    std::span<const float> min_x;
+    std::span<const float> min_y;
+    std::span<const float> min_z;
+    std::span<const float> max_x;
+    std::span<const float> max_y;
+    std::span<const float> max_z;
+
+    size_t size() const
+    {
+        return min_x.size();
+    }
+};
+
+struct sphere_span
+{
+    std::span<const float> x;
+    std::span<const float> y;
+    std::span<const float> z;
+    std::span<const float> radius;
+
+    size_t size() const
+    {
+        return x.size();
+    }
+};
+
+struct Frustum
+{
+    // (nx, ny, nz, d). inside if dot(n, p) + d >= 0. normalized
+    // left, right, bottom, top, near, far
+    std::array<float4, 6> planes;
+
+    // Gribb/Hartmann. clip = [p, 1] * viewProjection
+    static Frustum FromRowMatrix(const std::array<float, 16> &m, ClipDepth depth)
+    {
+        auto col = [&m](int j) {
+            return float4{m[j], m[4 + j], m[8 + j], m[12 + j]};
+        };
+        auto c0 = col(0);
+        auto c1 = col(1);
+        auto c2 = col(2);
+        auto c3 = col(3);
+        Frustum f{{
+            Add(c3, c0),
+            Sub(c3, c0),
+            Add(c3, c1),
+            Sub(c3, c1),
+            depth == ClipDepth::ZeroToOne ? c2 : Add(c3, c2),
+            Sub(c3, c2),
+        }};
+        for (auto &p : f.planes)
+        {
+            p = MulScalar(p, 1.0f / Length(float3{p[0], p[1], p[2]}));
+        }
+        return f;
+    }
+
+    static Frustum FromViewProjection(const std::array<float, 16> &view, const std::array<float, 16> &projection, ClipDepth depth)
+    {
+        return FromRowMatrix(RowMatrixMul(view, projection), depth);
+    }
+
+    bool ContainsSphere(const float3 &center, float radius) const
+    {
+        for (auto &p : planes)
+        {
+            if (p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3] < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // conservative. false only if the box is outside of one plane
+    bool ContainsAABB(const float3 &min, const float3 &max) const
+    {
+        for (auto &p : planes)
+        {
+            // the corner farthest along the plane normal
+            auto x = p[0] >= 0 ? max[0] : min[0];
+            auto y = p[1] >= 0 ? max[1] : min[1];
+            auto z = p[2] >= 0 ? max[2] : min[2];
+            if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// write the indices of visible boxes to visible. return the count.
+// visible must hold bounds.size() indices
+inline size_t CullAABBs(const Frustum &frustum, const aabb_span &bounds, std::span<uint32_t> visible)
+{
+    size_t count = 0;
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    auto half = _mm_set1_ps(0.5f);
+    auto abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; i + 4 <= bounds.size(); i += 4)
+    {
+        auto min_x = _mm_loadu_ps(&bounds.min_x[i]);
+        auto min_y = _mm_loadu_ps(&bounds.min_y[i]);
+        auto min_z = _mm_loadu_ps(&bounds.min_z[i]);
+        auto max_x = _mm_loadu_ps(&bounds.max_x[i]);
+        auto max_y = _mm_loadu_ps(&bounds.max_y[i]);
+        auto max_z = _mm_loadu_ps(&bounds.max_z[i]);
+        auto cx = _mm_mul_ps(_mm_add_ps(min_x, max_x), half);
+        auto cy = _mm_mul_ps(_mm_add_ps(min_y, max_y), half);
+        auto cz = _mm_mul_ps(_mm_add_ps(min_z, max_z), half);
+        auto ex = _mm_mul_ps(_mm_sub_ps(max_x, min_x), half);
+        auto ey = _mm_mul_ps(_mm_sub_ps(max_y, min_y), half);
+        auto ez = _mm_mul_ps(_mm_sub_ps(max_z, min_z), half);
+        auto outside = _mm_setzero_ps();
+        for (auto &p : frustum.planes)
+        {
+            auto nx = _mm_set1_ps(p[0]);
+            auto ny = _mm_set1_ps(p[1]);
+            auto nz = _mm_set1_ps(p[2]);
+            // distance of the center + projected radius of the box
+            auto d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(p[3])));
+            auto r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, abs_mask), ex), _mm_mul_ps(_mm_and_ps(ny, abs_mask), ey)),
+                                _mm_mul_ps(_mm_and_ps(nz, abs_mask), ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+        auto mask = ~_mm_movemask_ps(outside) & 0xF;
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            // branchless compaction
+            visible[count] = static_cast<uint32_t>(i + j);
+            count += (mask >> j) & 1;
+        }
+    }
+#endif
+    for (; i < bounds.size(); ++i)
+    {
+        if (frustum.ContainsAABB({bounds.min_x[i], bounds.min_y[i], bounds.min_z[i]},
+                                 {bounds.max_x[i], bounds.max_y[i], bounds.max_z[i]}))
+        {
+            visible[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+inline size_t CullSpheres(const Frustum &frustum, const sphere_span &bounds, std::span<uint32_t> visible)
+{
+    size_t count = 0;
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    for (; i + 4 <= bounds.size(); i += 4)
+    {
+        auto x = _mm_loadu_ps(&bounds.x[i]);
+        auto y = _mm_loadu_ps(&bounds.y[i]);
+        auto z = _mm_loadu_ps(&bounds.z[i]);
+        auto nr = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&bounds.radius[i]));
+        auto outside = _mm_setzero_ps();
+        for (auto &p : frustum.planes)
+        {
+            auto d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), x), _mm_mul_ps(_mm_set1_ps(p[1]), y)),
+                                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[2]), z), _mm_set1_ps(p[3])));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, nr));
+        }
+        auto mask = ~_mm_movemask_ps(outside) & 0xF;
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            visible[count] = static_cast<uint32_t>(i + j);
+            count += (mask >> j) & 1;
+        }
+    }
+#endif
+    for (; i < bounds.size(); ++i)
+    {
+        if (frustum.ContainsSphere({bounds.x[i], bounds.y[i], bounds.z[i]}, bounds.radius[i]))
+        {
+            visible[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+///
+/// bounding volumes
+///
+/// ray tests return the distance along the ray like operator>>(Ray, Triangle). infinity if missed.
+/// a ray starting inside returns 0.
+///
+namespace detail
+{
+// std::abs is not constexpr until C++23
+constexpr float abs(float value)
+{
+    return value < 0 ? -value : value;
+}
+
+// rows of an affine row matrix
+constexpr AffineBasis row_matrix_basis(const std::array<float, 16> &m)
+{
+    return {
+        {m[0], m[1], m[2]},
+        {m[4], m[5], m[6]},
+        {m[8], m[9], m[10]},
+        {m[12], m[13], m[14]},
+    };
+}
+} // namespace detail
+
+struct AABB
+{
+    // empty. Expand sets both
+    float3 min{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+    float3 max{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+
+    constexpr bool IsEmpty() const
+    {
+        return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+    }
+
+    constexpr float3 Center() const
+    {
+        return MulScalar(Add(min, max), 0.5f);
+    }
+
+    // half size
+    constexpr float3 Extents() const
+    {
+        return MulScalar(Sub(max, min), 0.5f);
+    }
+
+    constexpr float SurfaceArea() const
+    {
+        if (IsEmpty())
+        {
+            return 0;
+        }
+        auto d = Sub(max, min);
+        return 2 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+    }
+
+    constexpr bool Contains(const float3 &p) const
+    {
+        return p[0] >= min[0] && p[0] <= max[0] && p[1] >= min[1] && p[1] <= max[1] && p[2] >= min[2] && p[2] <= max[2];
+    }
+
+    constexpr bool Overlaps(const AABB &rhs) const
+    {
+        return min[0] <= rhs.max[0] && max[0] >= rhs.min[0] && min[1] <= rhs.max[1] && max[1] >= rhs.min[1] && min[2] <= rhs.max[2] && max[2] >= rhs.min[2];
+    }
+
+    constexpr void Expand(const float3 &p)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            min[i] = std::min(min[i], p[i]);
+            max[i] = std::max(max[i], p[i]);
+        }
+    }
+
+    constexpr void Expand(const AABB &rhs)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            min[i] = std::min(min[i], rhs.min[i]);
+            max[i] = std::max(max[i], rhs.max[i]);
+        }
+    }
+
+    // grow by margin on every side
+    constexpr AABB Inflate(float margin) const
+    {
+        return {Sub(min, {margin, margin, margin}), Add(max, {margin, margin, margin})};
+    }
+
+    // the box around the transformed box. each new extent sums the absolute rotated axes
+    constexpr AABB Transform(const AffineBasis &b) const
+    {
+        if (IsEmpty())
+        {
+            return *this;
+        }
+        auto c = b.ApplyPosition(Center());
+        auto e = Extents();
+        float3 r;
+        for (int i = 0; i < 3; ++i)
+        {
+            r[i] = detail::abs(b.x[i]) * e[0] + detail::abs(b.y[i]) * e[1] + detail::abs(b.z[i]) * e[2];
+        }
+        return {Sub(c, r), Add(c, r)};
+    }
+
+    constexpr AABB Transform(const falg::Transform &t) const
+    {
+        return Transform(t.Basis());
+    }
+
+    // affine row matrix. TRS::RowMatrix or a world matrix of the scene
+    constexpr AABB Transform(const std::array<float, 16> &m) const
+    {
+        return Transform(detail::row_matrix_basis(m));
+    }
+
+    static AABB FromPoints(std::span<const float3> points)
+    {
+        AABB aabb;
+        for (auto &p : points)
+        {
+            aabb.Expand(p);
+        }
+        return aabb;
+    }
+};
+
+constexpr AABB Merge(const AABB &lhs, const AABB &rhs)
+{
+    auto aabb = lhs;
+    aabb.Expand(rhs);
+    return aabb;
+}
+
+struct Sphere
+{
+    float3 center{0, 0, 0};
+    // negative is empty
+    float radius = -1;
+
+    constexpr bool IsEmpty() const
+    {
+        return radius < 0;
+    }
+
+    bool Contains(const float3 &p) const
+    {
+        return Length(Sub(p, center)) <= radius;
+    }
+
+    // grow to include p. the center moves toward p
+    void Expand(const float3 &p)
+    {
+        if (IsEmpty())
+        {
+            center = p;
+            radius = 0;
+            return;
+        }
+        auto d = Sub(p, center);
+        auto l = Length(d);
+        if (l > radius)
+        {
+            auto r = (radius + l) * 0.5f;
+            center = MulAdd(d, (r - radius) / l, center);
+            radius = r;
+        }
+    }
+
+    void Expand(const Sphere &rhs)
+    {
+        if (rhs.IsEmpty())
+        {
+            return;
+        }
+        if (IsEmpty())
+        {
+            *this = rhs;
+            return;
+        }
+        auto d = Sub(rhs.center, center);
+        auto l = Length(d);
+        if (l + rhs.radius <= radius)
+        {
+            // rhs is inside
+            return;
+        }
+        if (l + radius <= rhs.radius)
+        {
+            *this = rhs;
+            return;
+        }
+        auto r = (l + radius + rhs.radius) * 0.5f;
+        center = MulAdd(d, (r - radius) / l, center);
+        radius = r;
+    }
+
+    Sphere Transform(const falg::Transform &t) const
+    {
+        return {t.ApplyPosition(center), radius};
+    }
+
+    // the radius is scaled by the longest axis
+    Sphere Transform(const std::array<float, 16> &m) const
+    {
+        auto b = detail::row_matrix_basis(m);
+        auto s = std::max(std::max(Length(b.x), Length(b.y)), Length(b.z));
+        return {b.ApplyPosition(center), radius * s};
+    }
+
+    // Ritter. two passes over the points, about 5% larger than the minimum
+    static Sphere FromPoints(std::span<const float3> points)
+    {
+        if (points.empty())
+        {
+            return {};
+        }
+        auto farthest = [points](const float3 &from) {
+            auto found = points[0];
+            float d = -1;
+            for (auto &p : points)
+            {
+                auto l = Dot(Sub(p, from), Sub(p, from));
+                if (l > d)
+                {
+                    d = l;
+                    found = p;
+                }
+            }
+            return found;
+        };
+        auto a = farthest(points[0]);
+        auto b = farthest(a);
+        Sphere sphere{MulScalar(Add(a, b), 0.5f), Length(Sub(b, a)) * 0.5f};
+        for (auto &p : points)
+        {
+            sphere.Expand(p);
+        }
+        return sphere;
+    }
+
+    static Sphere FromAABB(const AABB &aabb)
+    {
+        if (aabb.IsEmpty())
+        {
+            return {};
+        }
+        return {aabb.Center(), Length(aabb.Extents())};
+    }
+};
+
+inline Sphere Merge(const Sphere &lhs, const Sphere &rhs)
+{
+    auto sphere = lhs;
+    sphere.Expand(rhs);
+    return sphere;
+}
+
+// box with a rotation. extents are half size on the local axes
+struct OBB
+{
+    float3 center{0, 0, 0};
+    float3 extents{0, 0, 0};
+    float4 rotation{0, 0, 0, 1};
+
+    static constexpr OBB FromAABB(const AABB &aabb, const falg::Transform &t = {})
+    {
+        return {t.ApplyPosition(aabb.Center()), aabb.Extents(), t.rotation};
+    }
+
+    constexpr falg::Transform LocalToWorld() const
+    {
+        return {center, rotation};
+    }
+
+    constexpr OBB Transform(const falg::Transform &t) const
+    {
+        return {t.ApplyPosition(center), extents, QuaternionMul(rotation, t.rotation)};
+    }
+
+    constexpr AABB ToAABB() const
+    {
+        return AABB{MulScalar(extents, -1), extents}.Transform(LocalToWorld());
+    }
+
+    bool Contains(const float3 &p) const
+    {
+        auto l = QuaternionRotateFloat3(QuaternionConjugate(rotation), Sub(p, center));
+        return std::abs(l[0]) <= extents[0] && std::abs(l[1]) <= extents[1] && std::abs(l[2]) <= extents[2];
+    }
+};
+
+namespace detail
+{
+// same operand order as _mm_min_ps / _mm_max_ps. the SSE and scalar paths agree on NaN
+constexpr float min_ps(float a, float b)
+{
+    return a < b ? a : b;
+}
+
+constexpr float max_ps(float a, float b)
+{
+    return a > b ? a : b;
+}
+
+// inverse direction for the slab test. 1 / 0 is infinity
+inline float3 inverse_direction(const float3 &d)
+{
+    return {1.0f / d[0], 1.0f / d[1], 1.0f / d[2]};
+}
+
+inline float ray_slab(const float3 &origin, const float3 &inv, const float3 &min, const float3 &max, float maxT)
+{
+    float near = 0;
+    float far = maxT;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto t0 = (min[i] - origin[i]) * inv[i];
+        auto t1 = (max[i] - origin[i]) * inv[i];
+        if (std::isinf(inv[i]))
+        {
+            // parallel to the slab with the origin on a face, 0 * inf is NaN. the face is inside, no limit
+            t0 = t0 == t0 ? t0 : -inv[i];
+            t1 = t1 == t1 ? t1 : inv[i];
+        }
+        near = max_ps(near, min_ps(t0, t1));
+        far = min_ps(far, max_ps(t0, t1));
+    }
+    return near <= far ? near : std::numeric_limits<float>::infinity();
+}
+} // namespace detail
+
+inline float operator>>(const Ray &ray, const AABB &aabb)
+{
+    return detail::ray_slab(ray.origin, detail::inverse_direction(ray.direction), aabb.min, aabb.max, std::numeric_limits<float>::infinity());
+}
+
+inline float operator>>(const Ray &ray, const OBB &obb)
+{
+    // direction is not normalized again. t is the same in both spaces
+    auto local = ray.ToLocal(obb.LocalToWorld());
+    return local >> AABB{MulScalar(obb.extents, -1), obb.extents};
+}
+
+inline float operator>>(const Ray &ray, const Sphere &sphere)
+{
+    auto m = Sub(ray.origin, sphere.center);
+    auto a = Dot(ray.direction, ray.direction);
+    auto b = Dot(m, ray.direction);
+    auto c = Dot(m, m) - sphere.radius * sphere.radius;
+    if (c <= 0)
+    {
+        // inside
+        return 0;
+    }
+    if (b > 0 || a == 0)
+    {
+        // away from the sphere
+        return std::numeric_limits<float>::infinity();
+    }
+    auto disc = b * b - a * c;
+    if (disc < 0)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+    return (-b - std::sqrt(disc)) / a;
+}
+
+///
+/// one ray against many boxes. 4 boxes per iteration in SSE2, same results as operator>>(Ray, AABB).
+///
+#if defined(FALG_SSE2)
+namespace detail
+{
+// near distance of 4 boxes. infinity if missed
+inline __m128 ray_slab_sse(const __m128 origin[3], const __m128 inv[3], const aabb_span &bounds, size_t i, __m128 maxT)
+{
+    auto near = _mm_setzero_ps();
+    auto far = maxT;
+    auto slab = [&](const float *min, const float *max, int k) {
+        auto t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(min), origin[k]), inv[k]);
+        auto t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(max), origin[k]), inv[k]);
+        if (std::isinf(_mm_cvtss_f32(inv[k])))
+        {
+            // NaN on the face, same as ray_slab. only a parallel axis, the same for all boxes
+            auto ordered0 = _mm_cmpord_ps(t0, t0);
+            auto ordered1 = _mm_cmpord_ps(t1, t1);
+            t0 = _mm_or_ps(_mm_and_ps(ordered0, t0), _mm_andnot_ps(ordered0, _mm_sub_ps(_mm_setzero_ps(), inv[k])));
+            t1 = _mm_or_ps(_mm_and_ps(ordered1, t1), _mm_andnot_ps(ordered1, inv[k]));
+        }
+        near = _mm_max_ps(near, _mm_min_ps(t0, t1));
+        far = _mm_min_ps(far, _mm_max_ps(t0, t1));
+    };
+    slab(&bounds.min_x[i], &bounds.max_x[i], 0);
+    slab(&bounds.min_y[i], &bounds.max_y[i], 1);
+    slab(&bounds.min_z[i], &bounds.max_z[i], 2);
+    auto hit = _mm_cmple_ps(near, far);
+    return _mm_or_ps(_mm_and_ps(hit, near), _mm_andnot_ps(hit, _mm_set1_ps(std::numeric_limits<float>::infinity())));
+}
+} // namespace detail
+#endif
+
+// t of each box. infinity if missed or farther than maxT
+inline void IntersectAABBs(const Ray &ray, const aabb_span &bounds, std::span<float> t,
+                           float maxT = std::numeric_limits<float>::infinity())
+{
+    auto inv = detail::inverse_direction(ray.direction);
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    __m128 o[] = {_mm_set1_ps(ray.origin[0]), _mm_set1_ps(ray.origin[1]), _mm_set1_ps(ray.origin[2])};
+    __m128 d[] = {_mm_set1_ps(inv[0]), _mm_set1_ps(inv[1]), _mm_set1_ps(inv[2])};
+    auto far = _mm_set1_ps(maxT);
+    for (; i + 4 <= bounds.size(); i += 4)
+    {
+        _mm_storeu_ps(&t[i], detail::ray_slab_sse(o, d, bounds, i, far));
+    }
+#endif
+    for (; i < bounds.size(); ++i)
+    {
+        t[i] = detail::ray_slab(ray.origin, inv, {bounds.min_x[i], bounds.min_y[i], bounds.min_z[i]},
+                                {bounds.max_x[i], bounds.max_y[i], bounds.max_z[i]}, maxT);
+    }
+}
+
+// write the indices of hit boxes to hits. return the count.
+// hits must hold bounds.size() indices
+inline size_t IntersectAABBs(const Ray &ray, const aabb_span &bounds, std::span<uint32_t> hits,
+                             float maxT = std::numeric_limits<float>::infinity())
+{
+    auto inv = detail::inverse_direction(ray.direction);
+    size_t count = 0;
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    __m128 o[] = {_mm_set1_ps(ray.origin[0]), _mm_set1_ps(ray.origin[1]), _mm_set1_ps(ray.origin[2])};
+    __m128 d[] = {_mm_set1_ps(inv[0]), _mm_set1_ps(inv[1]), _mm_set1_ps(inv[2])};
+    auto far = _mm_set1_ps(maxT);
+    auto miss = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    for (; i + 4 <= bounds.size(); i += 4)
+    {
+        auto mask = _mm_movemask_ps(_mm_cmpneq_ps(detail::ray_slab_sse(o, d, bounds, i, far), miss));
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            hits[count] = static_cast<uint32_t>(i + j);
+            count += (mask >> j) & 1;
+        }
+    }
+#endif
+    for (; i < bounds.size(); ++i)
+    {
+        if (detail::ray_slab(ray.origin, inv, {bounds.min_x[i], bounds.min_y[i], bounds.min_z[i]},
+                             {bounds.max_x[i], bounds.max_y[i], bounds.max_z[i]}, maxT) != std::numeric_limits<float>::infinity())
+        {
+            hits[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+static_assert(Merge(AABB{{0, 0, 0}, {1, 1, 1}}, AABB{{-1, 2, 0}, {0, 3, 1}}).max == float3{1, 3, 1}, "Merge");
+static_assert(AABB{{-1, -1, -1}, {1, 1, 1}}.Transform(Transform{{1, 0, 0}, {0, 0, 1, 0}}).min == float3{0, -1, -1}, "AABB::Transform");
+static_assert(AABB{}.IsEmpty(), "AABB::IsEmpty");
+
+///
+/// half
+///
+/// IEEE 754 binary16 for R16G16_FLOAT / R16G16B16A16_FLOAT vertices and textures.
+/// float to half rounds to nearest even. NaN keeps the upper payload bits and is quiet.
+/// results are the same as the F16C instructions (vcvtps2ph / vcvtph2ps).
+///
+using half2 = std::array<uint16_t, 2>;
+using half4 = std::array<uint16_t, 4>;
+
+constexpr uint16_t FloatToHalf(float value)
+{
+    auto f = std::bit_cast<uint32_t>(value);
+    auto sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+    f &= 0x7FFFFFFF;
+    if (f >= 0x47800000)
+    {
+        // 65536 or more. inf or NaN
+        if (f > 0x7F800000)
+        {
+            return sign | 0x7E00 | ((f >> 13) & 0x3FF);
+        }
+        return sign | 0x7C00;
+    }
+    if (f < 0x38800000)
+    {
+        // less than 2^-14. the float add rounds into the denormal
+        auto rounded = std::bit_cast<uint32_t>(std::bit_cast<float>(f) + 0.5f);
+        return sign | static_cast<uint16_t>(rounded - 0x3F000000);
+    }
+    // rebias exponent and round to nearest even. a carry goes into the exponent (65520 -> inf)
+    auto odd = (f >> 13) & 1;
+    f += 0xC8000FFF + odd;
+    return sign | static_cast<uint16_t>(f >> 13);
+}
+
+constexpr float HalfToFloat(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+    if (exponent == 0x1F)
+    {
+        // inf or NaN. NaN is quiet
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13) | (mantissa ? 0x400000 : 0));
+    }
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            return std::bit_cast<float>(sign);
+        }
+        // denormal. normalize
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x400) == 0)
+        {
+            mantissa <<= 1;
+            --exponent;
+        }
+        return std::bit_cast<float>(sign | (exponent << 23) | ((mantissa & 0x3FF) << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+}
+
+#if defined(FALG_SSE2)
+namespace detail
+{
+// 4 floats to 4 halves in the low 16 bits of each lane. same as FloatToHalf
+inline __m128i float_to_half_sse2(__m128 value)
+{
+    auto f = _mm_castps_si128(value);
+    auto sign = _mm_and_si128(f, _mm_set1_epi32(0x80000000));
+    f = _mm_xor_si128(f, sign);
+
+    auto odd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+    auto normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(f, _mm_set1_epi32(0xC8000FFF)), odd), 13);
+
+    auto magic = _mm_set1_ps(0.5f);
+    auto denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), magic)), _mm_castps_si128(magic));
+
+    auto nan = _mm_or_si128(_mm_set1_epi32(0x7E00), _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(0x3FF)));
+    auto isNan = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x7F800000));
+    auto special = _mm_or_si128(_mm_and_si128(isNan, nan), _mm_andnot_si128(isNan, _mm_set1_epi32(0x7C00)));
+
+    auto isDenormal = _mm_cmplt_epi32(f, _mm_set1_epi32(0x38800000));
+    auto isSpecial = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x477FFFFF));
+    auto h = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+    h = _mm_or_si128(_mm_and_si128(isSpecial, special), _mm_andnot_si128(isSpecial, h));
+    return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+}
+
+// 4 halves in the low 16 bits of each lane to 4 floats. same as HalfToFloat
+inline __m128 half_to_float_sse2(__m128i h)
+{
+    auto sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    auto em = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13);
+    auto exponent = _mm_and_si128(em, _mm_set1_epi32(0x0F800000));
+
+    // rebias. inf and NaN get the max exponent, NaN is quiet
+    auto f = _mm_add_epi32(em, _mm_set1_epi32((127 - 15) << 23));
+    auto isSpecial = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x0F800000));
+    auto isNan = _mm_and_si128(isSpecial, _mm_cmpgt_epi32(em, _mm_set1_epi32(0x0F800000)));
+    f = _mm_add_epi32(f, _mm_and_si128(isSpecial, _mm_set1_epi32((128 - 16) << 23)));
+    f = _mm_or_si128(f, _mm_and_si128(isNan, _mm_set1_epi32(0x400000)));
+
+    // denormal. 2^-14 * (1 + m) - 2^-14 is exact
+    auto magic = _mm_set1_epi32(113 << 23);
+    auto denormal = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(em, magic)), _mm_castsi128_ps(magic)));
+    auto isDenormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+    f = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, f));
+    return _mm_castsi128_ps(_mm_or_si128(f, sign));
+}
+} // namespace detail
+
+// software, SSE2 only
+inline void FloatToHalfSSE2(std::span<const float> src, std::span<uint16_t> dst)
+{
+    size_t i = 0;
+    for (; i + 8 <= src.size(); i += 8)
+    {
+        auto lo = detail::float_to_half_sse2(_mm_loadu_ps(&src[i]));
+        auto hi = detail::float_to_half_sse2(_mm_loadu_ps(&src[i + 4]));
+        // sign extend the 16 bits so that the signed saturation keeps them
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packs_epi32(lo, hi));
+    }
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = FloatToHalf(src[i]);
+    }
+}
+
+inline void HalfToFloatSSE2(std::span<const uint16_t> src, std::span<float> dst)
+{
+    size_t i = 0;
+    auto zero = _mm_setzero_si128();
+    for (; i + 8 <= src.size(); i += 8)
+    {
+        auto h = _mm_loadu_si128((const __m128i *)&src[i]);
+        _mm_storeu_ps(&dst[i], detail::half_to_float_sse2(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(&dst[i + 4], detail::half_to_float_sse2(_mm_unpackhi_epi16(h, zero)));
+    }
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = HalfToFloat(src[i]);
+    }
+}
+
+// needs a cpu with F16C. see falg_dispatch.h
+FALG_TARGET("avx,f16c") inline void FloatToHalfF16C(std::span<const float> src, std::span<uint16_t> dst)
+{
+    size_t i = 0;
+    for (; i + 8 <= src.size(); i += 8)
+    {
+        _mm_storeu_si128((__m128i *)&dst[i], _mm256_cvtps_ph(_mm256_loadu_ps(&src[i]), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = FloatToHalf(src[i]);
+    }
+}
+
+FALG_TARGET("avx,f16c") inline void HalfToFloatF16C(std::span<const uint16_t> src, std::span<float> dst)
+{
+    size_t i = 0;
+    for (; i + 8 <= src.size(); i += 8)
+    {
+        _mm256_storeu_ps(&dst[i], _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)&src[i])));
+    }
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = HalfToFloat(src[i]);
+    }
+}
+#endif
+
+// dst.size() >= src.size()
+inline void FloatToHalf(std::span<const float> src, std::span<uint16_t> dst)
+{
+#if defined(FALG_F16C)
+    FloatToHalfF16C(src, dst);
+#elif defined(FALG_SSE2)
+    FloatToHalfSSE2(src, dst);
+#else
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        dst[i] = FloatToHalf(src[i]);
+    }
+#endif
+}
+
+inline void HalfToFloat(std::span<const uint16_t> src, std::span<float> dst)
+{
+#if defined(FALG_F16C)
+    HalfToFloatF16C(src, dst);
+#elif defined(FALG_SSE2)
+    HalfToFloatSSE2(src, dst);
+#else
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        dst[i] = HalfToFloat(src[i]);
+    }
+#endif
+}
+
+static_assert(FloatToHalf(1.0f) == 0x3C00, "FloatToHalf");
+static_assert(FloatToHalf(-2.0f) == 0xC000, "FloatToHalf");
+static_assert(FloatToHalf(65520.0f) == 0x7C00, "FloatToHalf");
+static_assert(HalfToFloat(0x3555) == 0.333251953125f, "HalfToFloat");
+static_assert(HalfToFloat(0x0001) == 5.9604644775390625e-8f, "HalfToFloat");
+
+struct Matrix2x3
+{
+    float3 x;
+    float3 y;
+
+    constexpr float3 Apply(const float2 &value) const
+    {
+        return {
+            x[0] * value[0] + y[0] * value[1],
+            x[1] * value[0] + y[1] * value[1],
+            x[2] * value[0] + y[2] * value[1],
+        };
+    }
+};
+
+struct m16
+{
+    float _11, _12, _13, _14;
+    float _21, _22, _23, _24;
+    float _31, _32, _33, _34;
+    float _41, _42, _43, _44;
+};
+
+constexpr std::array<float, 3> MatrixToTranslation(const m16 &m)
+{
+    return {m._41, m._42, m._43};
+}
+
+template <typename T>
+std::array<float, 3> MatrixToTranslation(const T &m)
+{
+    return MatrixToTranslation(size_cast<m16>(m));
+}
+
+// branchless. the largest of 4w^2, 4x^2, 4y^2, 4z^2 from the diagonal is the divisor,
+// the other components come from the off diagonal. w >= 0
+inline std::array<float, 4> ColMatrixToQuaternion(const m16 &m)
+{
+    float tw = 1.0f + m._11 + m._22 + m._33;
+    float tx = 1.0f + m._11 - m._22 - m._33;
+    float ty = 1.0f - m._11 + m._22 - m._33;
+    float tz = 1.0f - m._11 - m._22 + m._33;
+    float d0 = m._32 - m._23;
+    float d1 = m._13 - m._31;
+    float d2 = m._21 - m._12;
+    float a0 = m._12 + m._21;
+    float a1 = m._13 + m._31;
+    float a2 = m._23 + m._32;
+
+    // w, x, y, z. a later one only when strictly larger
+    float t = tw;
+    float4 q{d0, d1, d2, tw};
+    bool bx = tx > t;
+    t = bx ? tx : t;
+    q = bx ? float4{tx, a0, a1, d0} : q;
+    bool by = ty > t;
+    t = by ? ty : t;
+    q = by ? float4{a0, ty, a2, d1} : q;
+    bool bz = tz > t;
+    t = bz ? tz : t;
+    q = bz ? float4{a1, a2, tz, d2} : q;
+
+    float s = std::copysign(0.5f / std::sqrt(t), q[3]);
+    return {q[0] * s, q[1] * s, q[2] * s, q[3] * s};
+}
+
+template <typename T>
+std::array<float, 4> ColMatrixToQuaternion(const T &m)
+{
+    return ColMatrixToQuaternion(size_cast<m16>(m));
+}
+
+template <typename T>
+std::array<float, 4> RowMatrixToQuaternion(const T &m)
+{
+    return QuaternionConjugate(ColMatrixToQuaternion(size_cast<m16>(m)));
+}
+
+// positive scale. the rows are normalized before the rotation is extracted
+template <typename T>
+TRS RowMatrixDecompose(const T &_m)
+{
+    auto &m = size_cast<row_matrix>(_m);
+    float3 x{m._11, m._12, m._13};
+    float3 y{m._21, m._22, m._23};
+    float3 z{m._31, m._32, m._33};
+    auto s1 = Length(x);
+    auto s2 = Length(y);
+    auto s3 = Length(z);
+    x = MulScalar(x, 1.0f / s1);
+    y = MulScalar(y, 1.0f / s2);
+    z = MulScalar(z, 1.0f / s3);
+    m16 r{
+        x[0], x[1], x[2], 0,
+        y[0], y[1], y[2], 0,
+        z[0], z[1], z[2], 0,
+        0, 0, 0, 1};
+    return TRS({m._41, m._42, m._43}, QuaternionConjugate(ColMatrixToQuaternion(r)), {s1, s2, s3});
+}
+
+///
+/// batch TRS
+///
+/// scene import / export. 4 nodes per iteration in SSE2,
+/// same results as TRS::RowMatrix and RowMatrixDecompose.
+///
+#if defined(FALG_SSE2)
+namespace detail
+{
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// ColMatrixToQuaternion of 4 matrices. _ij in SoA
+inline void col_matrix_to_quaternion(
+    __m128 _11, __m128 _12, __m128 _13,
+    __m128 _21, __m128 _22, __m128 _23,
+    __m128 _31, __m128 _32, __m128 _33,
+    __m128 q[4])
+{
+    auto one = _mm_set1_ps(1.0f);
+    auto tw = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _11), _22), _33);
+    auto tx = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(one, _11), _22), _33);
+    auto ty = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(one, _11), _22), _33);
+    auto tz = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(one, _11), _22), _33);
+    auto d0 = _mm_sub_ps(_32, _23);
+    auto d1 = _mm_sub_ps(_13, _31);
+    auto d2 = _mm_sub_ps(_21, _12);
+    auto a0 = _mm_add_ps(_12, _21);
+    auto a1 = _mm_add_ps(_13, _31);
+    auto a2 = _mm_add_ps(_23, _32);
+
+    auto t = tw;
+    auto x = d0;
+    auto y = d1;
+    auto z = d2;
+    auto w = tw;
+    auto bx = _mm_cmpgt_ps(tx, t);
+    t = select(bx, tx, t);
+    x = select(bx, tx, x);
+    y = select(bx, a0, y);
+    z = select(bx, a1, z);
+    w = select(bx, d0, w);
+    auto by = _mm_cmpgt_ps(ty, t);
+    t = select(by, ty, t);
+    x = select(by, a0, x);
+    y = select(by, ty, y);
+    z = select(by, a2, z);
+    w = select(by, d1, w);
+    auto bz = _mm_cmpgt_ps(tz, t);
+    t = select(bz, tz, t);
+    x = select(bz, a1, x);
+    y = select(bz, a2, y);
+    z = select(bz, tz, z);
+    w = select(bz, d2, w);
+
+    auto sign = _mm_set1_ps(-0.0f);
+    auto s = _mm_div_ps(_mm_set1_ps(0.5f), _mm_sqrt_ps(t));
+    s = _mm_or_ps(_mm_andnot_ps(sign, s), _mm_and_ps(sign, w));
+    q[0] = _mm_mul_ps(x, s);
+    q[1] = _mm_mul_ps(y, s);
+    q[2] = _mm_mul_ps(z, s);
+    q[3] = _mm_mul_ps(w, s);
+}
+} // namespace detail
+#endif
+
+#if defined(FALG_SSE2)
+namespace detail
+{
+// TRS::RowMatrix of 4 nodes in SoA. dst is 4 consecutive matrices
+inline void compose_trs(__m128 x, __m128 y, __m128 z, __m128 w,
+                        const __m128 scale[3], const __m128 translation[3], float16 *dst)
+{
+    // QuaternionXDir, YDir, ZDir
+    auto two = _mm_set1_ps(2.0f);
+    auto ww = _mm_mul_ps(w, w);
+    auto xx = _mm_mul_ps(x, x);
+    auto yy = _mm_mul_ps(y, y);
+    auto zz = _mm_mul_ps(z, z);
+    auto xy = _mm_mul_ps(x, y);
+    auto zw = _mm_mul_ps(z, w);
+    auto zx = _mm_mul_ps(z, x);
+    auto yw = _mm_mul_ps(y, w);
+    auto yz = _mm_mul_ps(y, z);
+    auto xw = _mm_mul_ps(x, w);
+    __m128 rows[3][3] = {
+        {
+            _mm_sub_ps(_mm_sub_ps(_mm_add_ps(ww, xx), yy), zz),
+            _mm_mul_ps(_mm_add_ps(xy, zw), two),
+            _mm_mul_ps(_mm_sub_ps(zx, yw), two),
+        },
+        {
+            _mm_mul_ps(_mm_sub_ps(xy, zw), two),
+            _mm_sub_ps(_mm_add_ps(_mm_sub_ps(ww, xx), yy), zz),
+            _mm_mul_ps(_mm_add_ps(yz, xw), two),
+        },
+        {
+            _mm_mul_ps(_mm_add_ps(zx, yw), two),
+            _mm_mul_ps(_mm_sub_ps(yz, xw), two),
+            _mm_add_ps(_mm_sub_ps(_mm_sub_ps(ww, xx), yy), zz),
+        },
+    };
+    for (int r = 0; r < 4; ++r)
+    {
+        __m128 c0, c1, c2, c3;
+        if (r < 3)
+        {
+            c0 = _mm_mul_ps(rows[r][0], scale[r]);
+            c1 = _mm_mul_ps(rows[r][1], scale[r]);
+            c2 = _mm_mul_ps(rows[r][2], scale[r]);
+            c3 = _mm_setzero_ps();
+        }
+        else
+        {
+            c0 = translation[0];
+            c1 = translation[1];
+            c2 = translation[2];
+            c3 = _mm_set1_ps(1.0f);
+        }
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        _mm_storeu_ps(&dst[0][r * 4], c0);
+        _mm_storeu_ps(&dst[1][r * 4], c1);
+        _mm_storeu_ps(&dst[2][r * 4], c2);
+        _mm_storeu_ps(&dst[3][r * 4], c3);
+    }
+}
+} // namespace detail
+#endif
+
+// dst.size() >= src.size()
+inline void ComposeTRS(std::span<const TRS> src, std::span<float16> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    for (; i + 4 <= src.size(); i += 4)
+    {
+        auto n = src.subspan(i, 4);
+        auto x = _mm_loadu_ps(n[0].rotation.data());
+        auto y = _mm_loadu_ps(n[1].rotation.data());
+        auto z = _mm_loadu_ps(n[2].rotation.data());
+        auto w = _mm_loadu_ps(n[3].rotation.data());
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        // float3 members are gathered. a 4 float load would read past their end
+        __m128 scale[3];
+        __m128 translation[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            scale[k] = _mm_setr_ps(n[0].scale[k], n[1].scale[k], n[2].scale[k], n[3].scale[k]);
+            translation[k] = _mm_setr_ps(n[0].translation[k], n[1].translation[k], n[2].translation[k], n[3].translation[k]);
+        }
+        detail::compose_trs(x, y, z, w, scale, translation, &dst[i]);
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = src[i].RowMatrix();
+    }
+}
+
+// TRS in separated arrays
+struct trs_span
+{
+    xyz_span<const float> translation;
+    std::span<const float> rotation_x;
+    std::span<const float> rotation_y;
+    std::span<const float> rotation_z;
+    std::span<const float> rotation_w;
+    xyz_span<const float> scale;
+
+    size_t size() const
+    {
+        return translation.size();
+    }
+
+    TRS operator[](size_t i) const
+    {
+        return {
+            {translation.x[i], translation.y[i], translation.z[i]},
+            {rotation_x[i], rotation_y[i], rotation_z[i], rotation_w[i]},
+            {scale.x[i], scale.y[i], scale.z[i]},
+        };
+    }
+};
+
+// SoA, no transpose on load
+inline void ComposeTRS(const trs_span &src, std::span<float16> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    for (; i + 4 <= src.size(); i += 4)
+    {
+        __m128 scale[3] = {
+            _mm_loadu_ps(&src.scale.x[i]),
+            _mm_loadu_ps(&src.scale.y[i]),
+            _mm_loadu_ps(&src.scale.z[i]),
+        };
+        __m128 translation[3] = {
+            _mm_loadu_ps(&src.translation.x[i]),
+            _mm_loadu_ps(&src.translation.y[i]),
+            _mm_loadu_ps(&src.translation.z[i]),
+        };
+        detail::compose_trs(
+            _mm_loadu_ps(&src.rotation_x[i]), _mm_loadu_ps(&src.rotation_y[i]),
+            _mm_loadu_ps(&src.rotation_z[i]), _mm_loadu_ps(&src.rotation_w[i]),
+            scale, translation, &dst[i]);
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = src[i].RowMatrix();
+    }
+}
+
+// dst.size() >= src.size()
+inline void Decompose(std::span<const float16> src, std::span<TRS> dst)
+{
+    size_t i = 0;
+#if defined(FALG_SSE2)
+    auto one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= src.size(); i += 4)
+    {
+        // axes of 4 matrices in SoA, normalized
+        __m128 axes[3][3];
+        __m128 scales[3];
+        for (int r = 0; r < 3; ++r)
+        {
+            auto c0 = _mm_loadu_ps(&src[i][r * 4]);
+            auto c1 = _mm_loadu_ps(&src[i + 1][r * 4]);
+            auto c2 = _mm_loadu_ps(&src[i + 2][r * 4]);
+            auto c3 = _mm_loadu_ps(&src[i + 3][r * 4]);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            auto length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, c0), _mm_mul_ps(c1, c1)), _mm_mul_ps(c2, c2)));
+            auto inv = _mm_div_ps(one, length);
+            axes[r][0] = _mm_mul_ps(c0, inv);
+            axes[r][1] = _mm_mul_ps(c1, inv);
+            axes[r][2] = _mm_mul_ps(c2, inv);
+            scales[r] = length;
+        }
+
+        __m128 q[4];
+        detail::col_matrix_to_quaternion(
+            axes[0][0], axes[0][1], axes[0][2],
+            axes[1][0], axes[1][1], axes[1][2],
+            axes[2][0], axes[2][1], axes[2][2],
+            q);
+
+        alignas(16) float qs[4][4];
+        alignas(16) float ss[3][4];
+        for (int j = 0; j < 4; ++j)
+        {
+            _mm_store_ps(qs[j], q[j]);
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            _mm_store_ps(ss[j], scales[j]);
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            auto &m = src[i + j];
+            // QuaternionConjugate
+            dst[i + j] = TRS({m[12], m[13], m[14]}, {-qs[0][j], -qs[1][j], -qs[2][j], qs[3][j]}, {ss[0][j], ss[1][j], ss[2][j]});
+        }
+    }
+#endif
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = RowMatrixDecompose(src[i]);
+    }
+}
+
+} // namespace falg
+
+/////////////////////////////////////////////////////////////////////////////
+// std
+/////////////////////////////////////////////////////////////////////////////
+namespace std
+{
+
+// for std::array
+constexpr falg::float3 operator-(const falg::float3 &lhs)
+{
+    return {-lhs[0], -lhs[1], -lhs[2]};
+}
+constexpr falg::float3 operator+(const falg::float3 &lhs, const falg::float3 &rhs)
+{
+    return {lhs[0] + rhs[0], lhs[1] + rhs[1], lhs[2] + rhs[2]};
+}
+constexpr falg::float3 &operator+=(falg::float3 &lhs, const falg::float3 &rhs)
+{
+    lhs[0] += rhs[0];
+    lhs[1] += rhs[1];
+    lhs[2] += rhs[2];
+    return lhs;
+}
+constexpr falg::float3 operator-(const falg::float3 &lhs, const falg::float3 &rhs)
+{
+    return {lhs[0] - rhs[0], lhs[1] - rhs[1], lhs[2] - rhs[2]};
+}
+constexpr falg::float3 operator*(const falg::float3 &lhs, float scalar)
+{
+    return {lhs[0] * scalar, lhs[1] * scalar, lhs[2] * scalar};
+}
+
+} // namespace std
@@ -0,0 +1,533 @@
+#pragma once
+#include "falg.h"
+#include <atomic>
+#if defined(FALG_SSE2)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+///
+/// runtime dispatch
+///
+/// falg.h selects SIMD at compile time. the batch kernels here are compiled for every
+/// instruction set and the best one for the running cpu is selected on the first call.
+///
+/// Kernels kernels = falg::dispatch::ActiveKernels();
+/// falg::dispatch::IsaName(kernels.isa); // "AVX512"
+///
+/// ForceIsa switches the whole table, for tests and benchmarks.
+/// every path keeps the operation order of the scalar code and returns bit exact results.
+///
+// AVX-512F includes FMA. keep mul and add separate like the scalar code
+#if defined(__GNUC__) && !defined(__clang__)
+#define FALG_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define FALG_NO_CONTRACT
+#endif
+
+namespace falg::dispatch
+{
+
+enum class Isa
+{
+    Scalar,
+    SSE2,
+    AVX,
+    AVX512,
+};
+
+inline const char *IsaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Scalar:
+        return "Scalar";
+    case Isa::SSE2:
+        return "SSE2";
+    case Isa::AVX:
+        return "AVX";
+    case Isa::AVX512:
+        return "AVX512";
+    }
+    return "unknown";
+}
+
+struct CpuFeatures
+{
+    bool sse2 = false;
+    bool sse41 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+};
+
+inline CpuFeatures DetectCpuFeatures()
+{
+    CpuFeatures features;
+#if defined(FALG_SSE2)
+    auto cpuid = [](uint32_t leaf, uint32_t sub, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+        __cpuidex((int *)regs, leaf, sub);
+#else
+        __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    };
+
+    uint32_t regs[4];
+    cpuid(0, 0, regs);
+    auto maxLeaf = regs[0];
+    if (maxLeaf < 1)
+    {
+        return features;
+    }
+
+    cpuid(1, 0, regs);
+    features.sse2 = (regs[3] & (1u << 26)) != 0;
+    features.sse41 = (regs[2] & (1u << 19)) != 0;
+    auto fma = (regs[2] & (1u << 12)) != 0;
+    auto osxsave = (regs[2] & (1u << 27)) != 0;
+    auto avx = (regs[2] & (1u << 28)) != 0;
+    auto f16c = (regs[2] & (1u << 29)) != 0;
+
+    // the os has to save the ymm / zmm registers
+    uint64_t xcr0 = 0;
+    if (osxsave)
+    {
+#if defined(_MSC_VER)
+        xcr0 = _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv"
+                         : "=a"(eax), "=d"(edx)
+                         : "c"(0));
+        xcr0 = ((uint64_t)edx << 32) | eax;
+#endif
+    }
+    auto ymm = (xcr0 & 0x06) == 0x06;
+    auto zmm = (xcr0 & 0xE6) == 0xE6;
+
+    features.avx = avx && ymm;
+    features.fma = fma && features.avx;
+    features.f16c = f16c && features.avx;
+    if (maxLeaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        features.avx2 = features.avx && (regs[1] & (1u << 5)) != 0;
+        features.avx512f = zmm && (regs[1] & (1u << 16)) != 0;
+    }
+#endif
+    return features;
+}
+
+inline const CpuFeatures &GetCpuFeatures()
+{
+    static CpuFeatures s_features = DetectCpuFeatures();
+    return s_features;
+}
+
+inline bool IsSupported(Isa isa)
+{
+    auto &features = GetCpuFeatures();
+    switch (isa)
+    {
+    case Isa::Scalar:
+        return true;
+    case Isa::SSE2:
+        return features.sse2;
+    case Isa::AVX:
+        return features.avx;
+    case Isa::AVX512:
+        return features.avx512f;
+    }
+    return false;
+}
+
+inline Isa BestIsa()
+{
+    for (auto isa : {Isa::AVX512, Isa::AVX, Isa::SSE2})
+    {
+        if (IsSupported(isa))
+        {
+            return isa;
+        }
+    }
+    return Isa::Scalar;
+}
+
+struct Kernels
+{
+    Isa isa;
+    // dst = basis * src. same as BatchApplyPositions
+    void (*apply_positions)(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst);
+    // dst[i] = l[i] * r[i]. same as RowMatrixMul
+    void (*row_matrix_mul)(std::span<const float16> l, std::span<const float16> r, std::span<float16> dst);
+    // same as IntersectTrianglePackets
+    RayHit (*intersect_triangle_packets)(const Ray &ray, std::span<const TrianglePacket> packets);
+    // same as FloatToHalf / HalfToFloat. F16C when the cpu has it
+    void (*float_to_half)(std::span<const float> src, std::span<uint16_t> dst);
+    void (*half_to_float)(std::span<const uint16_t> src, std::span<float> dst);
+};
+
+namespace detail
+{
+
+//
+// Scalar
+//
+inline void apply_positions_scalar(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        auto v = b.ApplyPosition({src.x[i], src.y[i], src.z[i]});
+        dst.x[i] = v[0];
+        dst.y[i] = v[1];
+        dst.z[i] = v[2];
+    }
+}
+
+inline void row_matrix_mul_scalar(std::span<const float16> l, std::span<const float16> r, std::span<float16> dst)
+{
+    for (size_t i = 0; i < dst.size(); ++i)
+    {
+        dst[i] = RowMatrixMulScalar(l[i], r[i]);
+    }
+}
+
+inline void float_to_half_scalar(std::span<const float> src, std::span<uint16_t> dst)
+{
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        dst[i] = FloatToHalf(src[i]);
+    }
+}
+
+inline void half_to_float_scalar(std::span<const uint16_t> src, std::span<float> dst)
+{
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        dst[i] = HalfToFloat(src[i]);
+    }
+}
+
+#if defined(FALG_SSE2)
+//
+// SSE2
+//
+inline void apply_positions_sse2(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    falg::BatchApplyPositions(b, src, dst);
+}
+
+inline void row_matrix_mul_sse2(std::span<const float16> l, std::span<const float16> r, std::span<float16> dst)
+{
+    for (size_t i = 0; i < dst.size(); ++i)
+    {
+        dst[i] = RowMatrixMulSSE2(l[i], r[i]);
+    }
+}
+
+//
+// AVX
+//
+FALG_TARGET("avx") inline void apply_positions_avx(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    size_t i = 0;
+    __m256 bx[3], by[3], bz[3], bt[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        bx[j] = _mm256_set1_ps(b.x[j]);
+        by[j] = _mm256_set1_ps(b.y[j]);
+        bz[j] = _mm256_set1_ps(b.z[j]);
+        bt[j] = _mm256_set1_ps(b.t[j]);
+    }
+    for (; i + 8 <= src.size(); i += 8)
+    {
+        auto x = _mm256_loadu_ps(&src.x[i]);
+        auto y = _mm256_loadu_ps(&src.y[i]);
+        auto z = _mm256_loadu_ps(&src.z[i]);
+        float *out[] = {&dst.x[i], &dst.y[i], &dst.z[i]};
+        for (int j = 0; j < 3; ++j)
+        {
+            auto v = _mm256_add_ps(_mm256_mul_ps(bx[j], x),
+                                   _mm256_add_ps(_mm256_mul_ps(by[j], y), _mm256_mul_ps(bz[j], z)));
+            _mm256_storeu_ps(out[j], _mm256_add_ps(v, bt[j]));
+        }
+    }
+    for (; i < src.size(); ++i)
+    {
+        auto v = b.ApplyPosition({src.x[i], src.y[i], src.z[i]});
+        dst.x[i] = v[0];
+        dst.y[i] = v[1];
+        dst.z[i] = v[2];
+    }
+}
+
+FALG_TARGET("avx") inline void row_matrix_mul_avx(std::span<const float16> l, std::span<const float16> r, std::span<float16> dst)
+{
+    for (size_t i = 0; i < dst.size(); ++i)
+    {
+        dst[i] = RowMatrixMulAVX(l[i], r[i]);
+    }
+}
+
+FALG_TARGET("avx") inline RayHit intersect_triangle_packets_avx(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+    return IntersectTrianglePacketsAVX(ray, packets);
+}
+
+//
+// AVX-512F
+//
+FALG_TARGET("avx512f") FALG_NO_CONTRACT inline void apply_positions_avx512(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    size_t i = 0;
+    __m512 bx[3], by[3], bz[3], bt[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        bx[j] = _mm512_set1_ps(b.x[j]);
+        by[j] = _mm512_set1_ps(b.y[j]);
+        bz[j] = _mm512_set1_ps(b.z[j]);
+        bt[j] = _mm512_set1_ps(b.t[j]);
+    }
+    for (; i + 16 <= src.size(); i += 16)
+    {
+        auto x = _mm512_loadu_ps(&src.x[i]);
+        auto y = _mm512_loadu_ps(&src.y[i]);
+        auto z = _mm512_loadu_ps(&src.z[i]);
+        float *out[] = {&dst.x[i], &dst.y[i], &dst.z[i]};
+        for (int j = 0; j < 3; ++j)
+        {
+            auto v = _mm512_add_ps(_mm512_mul_ps(bx[j], x),
+                                   _mm512_add_ps(_mm512_mul_ps(by[j], y), _mm512_mul_ps(bz[j], z)));
+            _mm512_storeu_ps(out[j], _mm512_add_ps(v, bt[j]));
+        }
+    }
+    for (; i < src.size(); ++i)
+    {
+        auto v = b.ApplyPosition({src.x[i], src.y[i], src.z[i]});
+        dst.x[i] = v[0];
+        dst.y[i] = v[1];
+        dst.z[i] = v[2];
+    }
+}
+
+// whole matrix in one zmm. each 128bit lane is a row of l
+FALG_TARGET("avx512f") FALG_NO_CONTRACT inline void row_matrix_mul_avx512(std::span<const float16> l, std::span<const float16> r, std::span<float16> dst)
+{
+    for (size_t i = 0; i < dst.size(); ++i)
+    {
+        auto &rm = r[i];
+        auto r0 = _mm512_set4_ps(rm[3], rm[2], rm[1], rm[0]);
+        auto r1 = _mm512_set4_ps(rm[7], rm[6], rm[5], rm[4]);
+        auto r2 = _mm512_set4_ps(rm[11], rm[10], rm[9], rm[8]);
+        auto r3 = _mm512_set4_ps(rm[15], rm[14], rm[13], rm[12]);
+        auto rows = _mm512_loadu_ps(l[i].data());
+        auto v = _mm512_mul_ps(_mm512_mask_permute_ps(rows, 0xFFFF, rows, 0x00), r0);
+        v = _mm512_add_ps(v, _mm512_mul_ps(_mm512_mask_permute_ps(rows, 0xFFFF, rows, 0x55), r1));
+        v = _mm512_add_ps(v, _mm512_mul_ps(_mm512_mask_permute_ps(rows, 0xFFFF, rows, 0xAA), r2));
+        v = _mm512_add_ps(v, _mm512_mul_ps(_mm512_mask_permute_ps(rows, 0xFFFF, rows, 0xFF), r3));
+        _mm512_storeu_ps(dst[i].data(), v);
+    }
+}
+
+FALG_TARGET("avx512f") FALG_NO_CONTRACT inline __m512 load_packet_pair(const float *lo, const float *hi)
+{
+    // masked forms, the unmasked ones warn -Wmaybe-uninitialized on gcc 12
+    auto v = _mm512_castps_pd(_mm512_castps256_ps512(_mm256_loadu_ps(lo)));
+    return _mm512_castpd_ps(_mm512_mask_insertf64x4(v, 0xFF, v, _mm256_castps_pd(_mm256_loadu_ps(hi)), 1));
+}
+
+// two packets per iteration. an odd tail is paired with an empty packet that never hits
+FALG_TARGET("avx512f") FALG_NO_CONTRACT inline RayHit intersect_triangle_packets_avx512(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+    static const TrianglePacket s_empty{};
+    auto load = load_packet_pair;
+
+    auto dx = _mm512_set1_ps(ray.direction[0]);
+    auto dy = _mm512_set1_ps(ray.direction[1]);
+    auto dz = _mm512_set1_ps(ray.direction[2]);
+    auto ox = _mm512_set1_ps(ray.origin[0]);
+    auto oy = _mm512_set1_ps(ray.origin[1]);
+    auto oz = _mm512_set1_ps(ray.origin[2]);
+    auto zero = _mm512_setzero_ps();
+    auto one = _mm512_set1_ps(1.0f);
+
+    auto best_t = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+    auto best_id = _mm512_set1_epi32(-1);
+    // triangle id per lane. lanes 0-7 are packet i, 8-15 are packet i + 1
+    auto id = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    auto step = _mm512_set1_epi32(16);
+    for (size_t i = 0; i < packets.size(); i += 2)
+    {
+        auto &p = packets[i];
+        auto &q = i + 1 < packets.size() ? packets[i + 1] : s_empty;
+        auto e1x = load(p.e1x, q.e1x);
+        auto e1y = load(p.e1y, q.e1y);
+        auto e1z = load(p.e1z, q.e1z);
+        auto e2x = load(p.e2x, q.e2x);
+        auto e2y = load(p.e2y, q.e2y);
+        auto e2z = load(p.e2z, q.e2z);
+        auto hx = _mm512_sub_ps(_mm512_mul_ps(dy, e2z), _mm512_mul_ps(dz, e2y));
+        auto hy = _mm512_sub_ps(_mm512_mul_ps(dz, e2x), _mm512_mul_ps(dx, e2z));
+        auto hz = _mm512_sub_ps(_mm512_mul_ps(dx, e2y), _mm512_mul_ps(dy, e2x));
+        auto a = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e1x, hx), _mm512_mul_ps(e1y, hy)), _mm512_mul_ps(e1z, hz));
+        auto f = _mm512_div_ps(one, a);
+        auto sx = _mm512_sub_ps(ox, load(p.v0x, q.v0x));
+        auto sy = _mm512_sub_ps(oy, load(p.v0y, q.v0y));
+        auto sz = _mm512_sub_ps(oz, load(p.v0z, q.v0z));
+        auto u = _mm512_mul_ps(f, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(sx, hx), _mm512_mul_ps(sy, hy)), _mm512_mul_ps(sz, hz)));
+        auto qx = _mm512_sub_ps(_mm512_mul_ps(sy, e1z), _mm512_mul_ps(sz, e1y));
+        auto qy = _mm512_sub_ps(_mm512_mul_ps(sz, e1x), _mm512_mul_ps(sx, e1z));
+        auto qz = _mm512_sub_ps(_mm512_mul_ps(sx, e1y), _mm512_mul_ps(sy, e1x));
+        auto v = _mm512_mul_ps(f, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, qx), _mm512_mul_ps(dy, qy)), _mm512_mul_ps(dz, qz)));
+        auto t = _mm512_mul_ps(f, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e2x, qx), _mm512_mul_ps(e2y, qy)), _mm512_mul_ps(e2z, qz)));
+
+        auto ok = _mm512_cmp_ps_mask(a, zero, _CMP_NEQ_UQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, u, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, u, one, _CMP_LE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, v, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, _mm512_add_ps(u, v), one, _CMP_LE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, t, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, t, best_t, _CMP_LT_OQ);
+        best_t = _mm512_mask_blend_ps(ok, best_t, t);
+        best_id = _mm512_mask_blend_epi32(ok, best_id, id);
+        id = _mm512_add_epi32(id, step);
+    }
+
+    alignas(64) float ts[16];
+    alignas(64) uint32_t ids[16];
+    _mm512_store_ps(ts, best_t);
+    _mm512_store_si512(ids, best_id);
+    RayHit hit;
+    for (int lane = 0; lane < 16; ++lane)
+    {
+        if (ts[lane] < hit.t || (ts[lane] == hit.t && ids[lane] < hit.triangle))
+        {
+            hit.t = ts[lane];
+            hit.triangle = ids[lane];
+        }
+    }
+    return hit;
+}
+
+FALG_TARGET("avx512f") inline void float_to_half_avx512(std::span<const float> src, std::span<uint16_t> dst)
+{
+    size_t i = 0;
+    for (; i + 16 <= src.size(); i += 16)
+    {
+        _mm256_storeu_si256((__m256i *)&dst[i], _mm512_maskz_cvtps_ph(0xFFFF, _mm512_loadu_ps(&src[i]), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = FloatToHalf(src[i]);
+    }
+}
+
+FALG_TARGET("avx512f") inline void half_to_float_avx512(std::span<const uint16_t> src, std::span<float> dst)
+{
+    size_t i = 0;
+    for (; i + 16 <= src.size(); i += 16)
+    {
+        _mm512_storeu_ps(&dst[i], _mm512_maskz_cvtph_ps(0xFFFF, _mm256_loadu_si256((const __m256i *)&src[i])));
+    }
+    for (; i < src.size(); ++i)
+    {
+        dst[i] = HalfToFloat(src[i]);
+    }
+}
+#endif
+
+inline const Kernels &GetKernels(Isa isa)
+{
+    static const Kernels s_scalar{Isa::Scalar, &apply_positions_scalar, &row_matrix_mul_scalar, &IntersectTrianglePacketsScalar,
+                                 &float_to_half_scalar, &half_to_float_scalar};
+#if defined(FALG_SSE2)
+    // F16C is a separate flag from AVX
+    auto f16c = GetCpuFeatures().f16c;
+    static const Kernels s_sse2{Isa::SSE2, &apply_positions_sse2, &row_matrix_mul_sse2, &IntersectTrianglePacketsSSE2,
+                                &FloatToHalfSSE2, &HalfToFloatSSE2};
+    static const Kernels s_avx{Isa::AVX, &apply_positions_avx, &row_matrix_mul_avx, &intersect_triangle_packets_avx,
+                               f16c ? &FloatToHalfF16C : &FloatToHalfSSE2, f16c ? &HalfToFloatF16C : &HalfToFloatSSE2};
+    static const Kernels s_avx512{Isa::AVX512, &apply_positions_avx512, &row_matrix_mul_avx512, &intersect_triangle_packets_avx512,
+                                  &float_to_half_avx512, &half_to_float_avx512};
+    switch (isa)
+    {
+    case Isa::SSE2:
+        return s_sse2;
+    case Isa::AVX:
+        return s_avx;
+    case Isa::AVX512:
+        return s_avx512;
+    default:
+        break;
+    }
+#endif
+    return s_scalar;
+}
+
+inline std::atomic<const Kernels *> &active_kernels()
+{
+    static std::atomic<const Kernels *> s_active{&GetKernels(BestIsa())};
+    return s_active;
+}
+
+} // namespace detail
+
+inline const Kernels &ActiveKernels()
+{
+    return *detail::active_kernels().load(std::memory_order_relaxed);
+}
+
+inline Isa ActiveIsa()
+{
+    return ActiveKernels().isa;
+}
+
+// false if the cpu does not support isa. the active table is unchanged
+inline bool ForceIsa(Isa isa)
+{
+    if (!IsSupported(isa))
+    {
+        return false;
+    }
+    detail::active_kernels().store(&detail::GetKernels(isa), std::memory_order_relaxed);
+    return true;
+}
+
+// back to the best isa of the cpu
+inline void ResetIsa()
+{
+    detail::active_kernels().store(&detail::GetKernels(BestIsa()), std::memory_order_relaxed);
+}
+
+inline void BatchApplyPositions(const AffineBasis &b, xyz_span<const float> src, xyz_span<float> dst)
+{
+    ActiveKernels().apply_positions(b, src, dst);
+}
+
+inline void BatchRowMatrixMul(std::span<const float16> l, std::span<const float16> r, std::span<float16> dst)
+{
+    ActiveKernels().row_matrix_mul(l, r, dst);
+}
+
+inline RayHit IntersectTrianglePackets(const Ray &ray, std::span<const TrianglePacket> packets)
+{
+    return ActiveKernels().intersect_triangle_packets(ray, packets);
+}
+
+inline void FloatToHalf(std::span<const float> src, std::span<uint16_t> dst)
+{
+    ActiveKernels().float_to_half(src, dst);
+}
+
+inline void HalfToFloat(std::span<const uint16_t> src, std::span<float> dst)
+{
+    ActiveKernels().half_to_float(src, dst);
+}
+
+} // namespace falg::dispatch
@@ -0,0 +1,503 @@
+#pragma once
+#include <falg.h>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+// 32 bytes. children of an inner node are next to each other
+struct BvhNode
+{
+    falg::float3 min;
+    // inner: index of the left child. right is + 1
+    // leaf: first index in Bvh::Indices()
+    uint32_t leftOrFirst;
+    falg::float3 max;
+    // 0 for an inner node
+    uint32_t count;
+
+    bool IsLeaf() const
+    {
+        return count > 0;
+    }
+
+    falg::AABB Bounds() const
+    {
+        return {min, max};
+    }
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode");
+
+namespace detail
+{
+// AABB for the build loops. one min / max instruction per expand in SSE2
+struct bin_box
+{
+#if defined(FALG_SSE2)
+    __m128 min = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 max = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+
+    bin_box() = default;
+    bin_box(const falg::AABB &aabb)
+        : min(_mm_setr_ps(aabb.min[0], aabb.min[1], aabb.min[2], 0)), max(_mm_setr_ps(aabb.max[0], aabb.max[1], aabb.max[2], 0))
+    {
+    }
+
+    void Expand(const bin_box &rhs)
+    {
+        min = _mm_min_ps(min, rhs.min);
+        max = _mm_max_ps(max, rhs.max);
+    }
+
+    falg::AABB ToAABB() const
+    {
+        alignas(16) float lo[4];
+        alignas(16) float hi[4];
+        _mm_store_ps(lo, min);
+        _mm_store_ps(hi, max);
+        return {{lo[0], lo[1], lo[2]}, {hi[0], hi[1], hi[2]}};
+    }
+
+    // same operation order as AABB::SurfaceArea
+    float SurfaceArea() const
+    {
+        auto d = _mm_sub_ps(max, min);
+        if (_mm_movemask_ps(_mm_cmplt_ps(d, _mm_setzero_ps())) & 7)
+        {
+            return 0;
+        }
+        auto p = _mm_mul_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 0, 2, 1)));
+        auto xy = _mm_cvtss_f32(p);
+        auto yz = _mm_cvtss_f32(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+        auto zx = _mm_cvtss_f32(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)));
+        return 2 * (xy + yz + zx);
+    }
+
+    bin_box Centroid() const
+    {
+        auto c = _mm_mul_ps(_mm_add_ps(min, max), _mm_set1_ps(0.5f));
+        bin_box box;
+        box.min = c;
+        box.max = c;
+        return box;
+    }
+
+    // (centroid - origin) * scale of each axis, truncated
+    std::array<int32_t, 4> Bins(const falg::float3 &origin, const falg::float3 &scale) const
+    {
+        auto c = _mm_mul_ps(_mm_add_ps(min, max), _mm_set1_ps(0.5f));
+        alignas(16) std::array<int32_t, 4> bins;
+        _mm_store_si128(reinterpret_cast<__m128i *>(bins.data()),
+                        _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(c, _mm_setr_ps(origin[0], origin[1], origin[2], 0)),
+                                                    _mm_setr_ps(scale[0], scale[1], scale[2], 0))));
+        return bins;
+    }
+#else
+    falg::AABB aabb;
+
+    bin_box() = default;
+    bin_box(const falg::AABB &_aabb)
+        : aabb(_aabb)
+    {
+    }
+
+    void Expand(const bin_box &rhs)
+    {
+        aabb.Expand(rhs.aabb);
+    }
+
+    falg::AABB ToAABB() const
+    {
+        return aabb;
+    }
+
+    float SurfaceArea() const
+    {
+        return aabb.SurfaceArea();
+    }
+
+    bin_box Centroid() const
+    {
+        auto c = aabb.Center();
+        return falg::AABB{c, c};
+    }
+
+    std::array<int32_t, 4> Bins(const falg::float3 &origin, const falg::float3 &scale) const
+    {
+        auto c = aabb.Center();
+        std::array<int32_t, 4> bins{};
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bins[axis] = static_cast<int32_t>((c[axis] - origin[axis]) * scale[axis]);
+        }
+        return bins;
+    }
+#endif
+};
+} // namespace detail
+
+///
+/// bounding volume hierarchy over primitive boxes. binned SAH build.
+///
+/// bvh.Build(bounds);
+/// bvh.Traverse(ray, t, [&](uint32_t first, uint32_t count) {
+///     // primitives bvh.Indices()[first, first + count). shrink t on hit
+/// });
+/// bvh.Refit(moved); // same primitives, new boxes. the tree is kept
+///
+class Bvh
+{
+public:
+    // the traversal stack. a deeper node becomes a leaf
+    static const uint32_t MAX_DEPTH = 64;
+
+private:
+    std::vector<BvhNode> m_nodes;
+    // primitive ids in leaf order
+    std::vector<uint32_t> m_indices;
+
+    struct Bin
+    {
+        detail::bin_box bounds;
+        uint32_t count = 0;
+    };
+
+    void SetBounds(BvhNode &node, std::span<const falg::AABB> bounds) const
+    {
+        falg::AABB aabb;
+        for (uint32_t i = 0; i < node.count; ++i)
+        {
+            aabb.Expand(bounds[m_indices[node.leftOrFirst + i]]);
+        }
+        node.min = aabb.min;
+        node.max = aabb.max;
+    }
+
+public:
+    std::span<const BvhNode> Nodes() const
+    {
+        return m_nodes;
+    }
+
+    std::span<const uint32_t> Indices() const
+    {
+        return m_indices;
+    }
+
+    bool IsEmpty() const
+    {
+        return m_nodes.empty();
+    }
+
+    falg::AABB Bounds() const
+    {
+        return m_nodes.empty() ? falg::AABB{} : m_nodes[0].Bounds();
+    }
+
+    void Clear()
+    {
+        m_nodes.clear();
+        m_indices.clear();
+    }
+
+    // split while the SAH cost improves or a node has more than maxLeafSize primitives.
+    // binCount candidate planes per axis instead of a sort per node
+    void Build(std::span<const falg::AABB> bounds, uint32_t maxLeafSize = 4, uint32_t binCount = 16)
+    {
+        Clear();
+        binCount = std::clamp(binCount, 2u, 256u);
+        if (bounds.empty())
+        {
+            return;
+        }
+
+        // partitioned in place. a node reads one contiguous range
+        struct Ref
+        {
+            detail::bin_box bounds;
+            uint32_t id;
+            // of the current node. for the partition
+            std::array<uint8_t, 3> bins;
+        };
+        auto count = static_cast<uint32_t>(bounds.size());
+        std::vector<Ref> refs(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            refs[i] = {bounds[i], i, {}};
+        }
+        m_nodes.reserve(count * 2 / std::max(maxLeafSize, 1u) + 1);
+        m_nodes.push_back({{}, 0, {}, count});
+
+        std::vector<Bin> bins(binCount * 3);
+        std::vector<float> rightArea(binCount);
+        std::vector<std::pair<uint32_t, uint32_t>> stack{{0, 0}};
+        while (!stack.empty())
+        {
+            auto [index, depth] = stack.back();
+            stack.pop_back();
+            auto &node = m_nodes[index];
+            auto begin = refs.begin() + node.leftOrFirst;
+            auto end = begin + node.count;
+
+            detail::bin_box box;
+            detail::bin_box centroidBox;
+            for (auto it = begin; it != end; ++it)
+            {
+                box.Expand(it->bounds);
+                centroidBox.Expand(it->bounds.Centroid());
+            }
+            auto aabb = box.ToAABB();
+            node.min = aabb.min;
+            node.max = aabb.max;
+            if (node.count <= 1 || depth + 1 >= MAX_DEPTH)
+            {
+                continue;
+            }
+            auto centroidBounds = centroidBox.ToAABB();
+
+            // bins of the 3 axes in one pass. a small node does not need many
+            auto nodeBins = std::min(binCount, node.count);
+            falg::float3 scale;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                auto extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+                scale[axis] = extent > 0 ? nodeBins / extent : 0;
+            }
+            auto binOf = [&](const Ref &ref) {
+                auto b = ref.bounds.Bins(centroidBounds.min, scale);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    b[axis] = std::min(static_cast<int32_t>(nodeBins) - 1, b[axis]);
+                }
+                return b;
+            };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                std::fill_n(bins.begin() + axis * binCount, nodeBins, Bin{});
+            }
+            for (auto it = begin; it != end; ++it)
+            {
+                auto b = binOf(*it);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    auto &bin = bins[axis * binCount + b[axis]];
+                    bin.bounds.Expand(it->bounds);
+                    ++bin.count;
+                    it->bins[axis] = static_cast<uint8_t>(b[axis]);
+                }
+            }
+
+            // the same unit as Cost(). one for the box test, one for each primitive
+            auto area = aabb.SurfaceArea();
+            auto leafCost = area * node.count;
+            auto bestCost = std::numeric_limits<float>::infinity();
+            int bestAxis = -1;
+            uint32_t bestBin = 0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (scale[axis] == 0)
+                {
+                    continue;
+                }
+                auto axisBins = bins.data() + axis * binCount;
+                detail::bin_box right;
+                for (auto b = nodeBins - 1; b > 0; --b)
+                {
+                    right.Expand(axisBins[b].bounds);
+                    rightArea[b] = right.SurfaceArea();
+                }
+                detail::bin_box left;
+                uint32_t leftCount = 0;
+                for (uint32_t b = 0; b + 1 < nodeBins; ++b)
+                {
+                    left.Expand(axisBins[b].bounds);
+                    leftCount += axisBins[b].count;
+                    auto cost = area + left.SurfaceArea() * leftCount + rightArea[b + 1] * (node.count - leftCount);
+                    if (leftCount > 0 && leftCount < node.count && cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = b;
+                    }
+                }
+            }
+
+            decltype(begin) middle;
+            if (bestAxis >= 0 && (bestCost < leafCost || node.count > maxLeafSize))
+            {
+                middle = std::partition(begin, end, [&](const Ref &ref) { return ref.bins[bestAxis] <= bestBin; });
+            }
+            else if (bestAxis < 0 && node.count > maxLeafSize)
+            {
+                // every centroid is the same. halve the node
+                middle = begin + node.count / 2;
+            }
+            else
+            {
+                continue;
+            }
+
+            auto first = node.leftOrFirst;
+            auto total = node.count;
+            auto leftCount = static_cast<uint32_t>(middle - begin);
+            auto left = static_cast<uint32_t>(m_nodes.size());
+            node.leftOrFirst = left;
+            node.count = 0;
+            // node is invalid after push_back
+            m_nodes.push_back({{}, first, {}, leftCount});
+            m_nodes.push_back({{}, first + leftCount, {}, total - leftCount});
+            stack.push_back({left + 1, depth + 1});
+            stack.push_back({left, depth + 1});
+        }
+
+        m_indices.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_indices[i] = refs[i].id;
+        }
+    }
+
+    // new boxes for the same primitives. children always come after the parent
+    void Refit(std::span<const falg::AABB> bounds)
+    {
+        for (auto i = m_nodes.size(); i-- > 0;)
+        {
+            auto &node = m_nodes[i];
+            if (node.IsLeaf())
+            {
+                SetBounds(node, bounds);
+            }
+            else
+            {
+                auto aabb = falg::Merge(m_nodes[node.leftOrFirst].Bounds(), m_nodes[node.leftOrFirst + 1].Bounds());
+                node.min = aabb.min;
+                node.max = aabb.max;
+            }
+        }
+    }
+
+    // SAH cost relative to the root. grows while Refit loosens the tree
+    float Cost() const
+    {
+        if (m_nodes.empty())
+        {
+            return 0;
+        }
+        auto rootArea = m_nodes[0].Bounds().SurfaceArea();
+        if (!(rootArea > 0))
+        {
+            return 0;
+        }
+        float cost = 0;
+        for (auto &node : m_nodes)
+        {
+            // one for the box test, one for each primitive
+            cost += node.Bounds().SurfaceArea() * (node.IsLeaf() ? node.count : 1);
+        }
+        return cost / rootArea;
+    }
+
+    // front to back. intersect(first, count) tests the primitives of a leaf and may shrink t
+    template <typename F>
+    void Traverse(const falg::Ray &ray, float &t, const F &intersect) const
+    {
+        if (m_nodes.empty())
+        {
+            return;
+        }
+        auto inv = falg::detail::inverse_direction(ray.direction);
+        auto slab = [&](const BvhNode &node) {
+            return falg::detail::ray_slab(ray.origin, inv, node.min, node.max, t);
+        };
+        if (std::isinf(slab(m_nodes[0])))
+        {
+            return;
+        }
+
+        std::array<uint32_t, MAX_DEPTH> stack;
+        uint32_t sp = 0;
+        uint32_t index = 0;
+        while (true)
+        {
+            auto &node = m_nodes[index];
+            if (node.IsLeaf())
+            {
+                intersect(node.leftOrFirst, node.count);
+            }
+            else
+            {
+                auto near = node.leftOrFirst;
+                auto far = near + 1;
+                auto tNear = slab(m_nodes[near]);
+                auto tFar = slab(m_nodes[far]);
+                if (tFar < tNear)
+                {
+                    std::swap(near, far);
+                    std::swap(tNear, tFar);
+                }
+                if (!std::isinf(tNear))
+                {
+                    if (!std::isinf(tFar))
+                    {
+                        stack[sp++] = far;
+                    }
+                    index = near;
+                    continue;
+                }
+            }
+
+            // a popped node may be farther than the current hit
+            while (true)
+            {
+                if (sp == 0)
+                {
+                    return;
+                }
+                index = stack[--sp];
+                if (!std::isinf(slab(m_nodes[index])))
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    // every primitive whose box overlaps aabb
+    template <typename F>
+    void Query(const falg::AABB &aabb, const F &callback) const
+    {
+        if (m_nodes.empty())
+        {
+            return;
+        }
+        std::array<uint32_t, MAX_DEPTH> stack;
+        uint32_t sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0)
+        {
+            auto &node = m_nodes[stack[--sp]];
+            if (!node.Bounds().Overlaps(aabb))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = 0; i < node.count; ++i)
+                {
+                    callback(m_indices[node.leftOrFirst + i]);
+                }
+            }
+            else
+            {
+                stack[sp++] = node.leftOrFirst + 1;
+                stack[sp++] = node.leftOrFirst;
+            }
+        }
+    }
+};
+
+} // namespace wgut::scene
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <falg.h>
+
+namespace wgut
+{
+
+enum class PerspectiveTypes
+{
+    OpenGL,
+    D3D,
+};
+
+struct CameraState
+{
+    // projection
+    float fovYRadians = 60.0f / 180.0f * 3.14f;
+    std::array<float, 16> projection;
+
+    // view
+    int viewportX = 0;
+    int viewportY = 0;
+    int viewportWidth = 1;
+    int viewportHeight = 1;
+    std::array<float, 16> view;
+
+    // viewInverse;
+    std::array<float, 3> position;
+    std::array<float, 4> rotation;
+
+    // ray for mousecursor
+    std::array<float, 3> ray_origin;
+    std::array<float, 3> ray_direction;
+};
+
+inline falg::Frustum CameraFrustum(const CameraState &state, PerspectiveTypes type = PerspectiveTypes::D3D)
+{
+    return falg::Frustum::FromViewProjection(state.view, state.projection,
+                                             type == PerspectiveTypes::OpenGL ? falg::ClipDepth::MinusOneToOne : falg::ClipDepth::ZeroToOne);
+}
+
+// ray for the mouse cursor
+inline falg::Ray CameraRay(const CameraState &state)
+{
+    return {state.ray_origin, state.ray_direction};
+}
+
+} // namespace wgut
@@ -0,0 +1,285 @@
+#pragma once
+#include <falg.h>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+struct KdNeighbor
+{
+    // index in the points of Build
+    uint32_t index;
+    float distanceSquared;
+    falg::float3 position;
+};
+
+///
+/// static k-d tree over points for nearest and radius queries.
+///
+/// the tree is implicit. the points of [begin, end) are split at the median (begin + end) / 2,
+/// the left half is [begin, median) and the right half is [median + 1, end).
+/// short ranges are leaves and scanned linearly. no node structs, no pointers.
+///
+/// KdTree tree;
+/// tree.Build(positions);
+/// auto nearest = tree.Nearest(p, maxDistance);
+/// KdNeighbor neighbors[8];
+/// auto count = tree.Nearest(p, neighbors); // sorted by distance
+///
+/// queries do not allocate. results are written to the caller buffer.
+///
+class KdTree
+{
+public:
+    static const uint32_t NONE = UINT32_MAX;
+    static const uint32_t LEAF_SIZE = 8;
+
+private:
+    // in tree order
+    std::vector<falg::float3> m_points;
+    std::vector<uint32_t> m_indices;
+    // split axis of each median. unused in leaves
+    std::vector<uint8_t> m_axes;
+    uint32_t m_depth = 0;
+
+    struct Range
+    {
+        uint32_t begin;
+        uint32_t end;
+        // squared distance from the query to the cell
+        float distanceSquared;
+    };
+    static const uint32_t MAX_STACK = 64;
+
+    struct Entry
+    {
+        falg::float3 point;
+        uint32_t index;
+    };
+
+    void Split(std::vector<Entry> &entries, uint32_t begin, uint32_t end, uint32_t depth)
+    {
+        m_depth = std::max(m_depth, depth);
+        if (end - begin <= LEAF_SIZE)
+        {
+            return;
+        }
+        falg::AABB aabb;
+        for (auto i = begin; i < end; ++i)
+        {
+            aabb.Expand(entries[i].point);
+        }
+        auto e = aabb.Extents();
+        uint8_t axis = e[1] > e[0] ? 1 : 0;
+        if (e[2] > e[axis])
+        {
+            axis = 2;
+        }
+        auto median = (begin + end) / 2;
+        std::nth_element(entries.begin() + begin, entries.begin() + median, entries.begin() + end,
+                         [axis](const Entry &l, const Entry &r) { return l.point[axis] < r.point[axis]; });
+        m_axes[median] = axis;
+        Split(entries, begin, median, depth + 1);
+        Split(entries, median + 1, end, depth + 1);
+    }
+
+    static float DistanceSquared(const falg::float3 &l, const falg::float3 &r)
+    {
+        auto x = l[0] - r[0];
+        auto y = l[1] - r[1];
+        auto z = l[2] - r[2];
+        return x * x + y * y + z * z;
+    }
+
+    ///
+    /// visit the points closer than the squared radius. f(i, d2) returns the new squared radius.
+    /// the nearer half is visited first and the farther half is skipped when the cell is out of the radius.
+    /// the distance to a cell is the distance to the splitting planes on the path
+    ///
+    template <typename F>
+    void Visit(const falg::float3 &p, float radiusSquared, const F &f) const
+    {
+        std::array<Range, MAX_STACK> stack;
+        uint32_t sp = 0;
+        stack[sp++] = {0, static_cast<uint32_t>(m_points.size()), 0};
+        while (sp > 0)
+        {
+            auto range = stack[--sp];
+            if (range.distanceSquared > radiusSquared)
+            {
+                continue;
+            }
+            if (range.end - range.begin <= LEAF_SIZE)
+            {
+                for (auto i = range.begin; i < range.end; ++i)
+                {
+                    auto d2 = DistanceSquared(m_points[i], p);
+                    if (d2 <= radiusSquared)
+                    {
+                        radiusSquared = f(i, d2);
+                    }
+                }
+                continue;
+            }
+
+            auto median = (range.begin + range.end) / 2;
+            auto axis = m_axes[median];
+            auto d = p[axis] - m_points[median][axis];
+            auto d2 = DistanceSquared(m_points[median], p);
+            if (d2 <= radiusSquared)
+            {
+                radiusSquared = f(median, d2);
+            }
+            Range left{range.begin, median, range.distanceSquared};
+            Range right{median + 1, range.end, range.distanceSquared};
+            // the far side is at least |d| away
+            auto &other = d < 0 ? right : left;
+            other.distanceSquared = std::max(range.distanceSquared, d * d);
+            // push far first, pop near first
+            stack[sp++] = d < 0 ? right : left;
+            stack[sp++] = d < 0 ? left : right;
+        }
+    }
+
+public:
+    size_t Size() const
+    {
+        return m_points.size();
+    }
+
+    // deepest range. the query stack is bounded by this
+    uint32_t Depth() const
+    {
+        return m_depth;
+    }
+
+    // positions in tree order
+    std::span<const falg::float3> Points() const
+    {
+        return m_points;
+    }
+
+    template <typename V>
+    void Build(std::span<const V> vertices, falg::float3 V::*position)
+    {
+        m_points.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            m_points[i] = vertices[i].*position;
+        }
+        Build();
+    }
+
+    void Build(std::span<const falg::float3> points)
+    {
+        m_points.assign(points.begin(), points.end());
+        Build();
+    }
+
+    // sort m_points into the tree order
+    void Build()
+    {
+        if (m_points.size() >= NONE)
+        {
+            throw std::runtime_error("too many points");
+        }
+        // points are moved with the indices. nth_element reads contiguous memory
+        std::vector<Entry> entries(m_points.size());
+        for (uint32_t i = 0; i < entries.size(); ++i)
+        {
+            entries[i] = {m_points[i], i};
+        }
+        m_axes.assign(m_points.size(), 0);
+        m_depth = 0;
+        Split(entries, 0, static_cast<uint32_t>(entries.size()), 0);
+        // the stack holds one far half per level
+        if (m_depth >= MAX_STACK - 1)
+        {
+            throw std::runtime_error("tree too deep");
+        }
+
+        m_indices.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            m_points[i] = entries[i].point;
+            m_indices[i] = entries[i].index;
+        }
+    }
+
+    // the nearest point within maxDistance. NONE if not found
+    uint32_t Nearest(const falg::float3 &p, float maxDistance = std::numeric_limits<float>::infinity()) const
+    {
+        return NearestNeighbor(p, maxDistance).index;
+    }
+
+    // the nearest point within maxDistance with the position. the index is NONE if not found
+    KdNeighbor NearestNeighbor(const falg::float3 &p, float maxDistance = std::numeric_limits<float>::infinity()) const
+    {
+        KdNeighbor found{NONE, maxDistance * maxDistance, p};
+        Visit(p, maxDistance * maxDistance, [&](uint32_t i, float d2) {
+            found = {i, d2, m_points[i]};
+            return d2;
+        });
+        if (found.index != NONE)
+        {
+            found.index = m_indices[found.index];
+        }
+        return found;
+    }
+
+    // the nearest dst.size() points within maxDistance, sorted by distance. returns the count
+    size_t Nearest(const falg::float3 &p, std::span<KdNeighbor> dst, float maxDistance = std::numeric_limits<float>::infinity()) const
+    {
+        if (dst.empty())
+        {
+            return 0;
+        }
+        // max heap of the found points
+        size_t count = 0;
+        auto less = [](const KdNeighbor &l, const KdNeighbor &r) { return l.distanceSquared < r.distanceSquared; };
+        Visit(p, maxDistance * maxDistance, [&](uint32_t i, float d2) {
+            if (count < dst.size())
+            {
+                dst[count++] = {i, d2, m_points[i]};
+                std::push_heap(dst.begin(), dst.begin() + count, less);
+            }
+            else if (d2 < dst[0].distanceSquared)
+            {
+                std::pop_heap(dst.begin(), dst.end(), less);
+                dst.back() = {i, d2, m_points[i]};
+                std::push_heap(dst.begin(), dst.end(), less);
+            }
+            // shrink the radius when full
+            return count < dst.size() ? maxDistance * maxDistance : dst[0].distanceSquared;
+        });
+        std::sort_heap(dst.begin(), dst.begin() + count, less);
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i].index = m_indices[dst[i].index];
+        }
+        return count;
+    }
+
+    // points within radius. not sorted. stops when dst is full, returns the count
+    size_t Radius(const falg::float3 &p, float radius, std::span<uint32_t> dst) const
+    {
+        size_t count = 0;
+        auto r2 = radius * radius;
+        Visit(p, r2, [&](uint32_t i, float) {
+            if (count < dst.size())
+            {
+                dst[count++] = m_indices[i];
+            }
+            // stop
+            return count < dst.size() ? r2 : -1.0f;
+        });
+        return count;
+    }
+};
+
+} // namespace wgut::scene
@@ -0,0 +1,299 @@
+#pragma once
+#include "CameraState.h"
+#include <falg.h>
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+struct LodLevel
+{
+    // handle of the mesh for the renderer
+    uint32_t mesh;
+    // geometric error of this level in world units. 0 for the full detail
+    float error;
+};
+
+///
+/// level of detail by the screen space error.
+/// the projected error of a level is error * viewportHeight / (2 * tan(fovY / 2) * distance) in pixels,
+/// the coarsest level under Threshold pixels is selected.
+///
+/// auto id = lod.AddObject(levels, sphere); // levels from fine to coarse
+/// lod.Select(camera.state);
+/// for (uint32_t level = 0; level < lod.LevelCount(); ++level)
+/// {
+///     for (auto object : lod.DrawList(level)) { draw lod.Mesh(object) }
+/// }
+///
+/// hysteresis. a coarser level is taken when it is under Threshold * (1 - Hysteresis),
+/// the current level is kept until it is over Threshold.
+///
+class LodSelector
+{
+public:
+    static const uint32_t MAX_LEVELS = 8;
+
+private:
+    struct Object
+    {
+        uint32_t firstLevel;
+        // 0 if removed
+        uint32_t levelCount;
+    };
+    std::vector<Object> m_objects;
+    std::vector<uint32_t> m_freeObjects;
+    std::vector<LodLevel> m_levels;
+    std::vector<uint32_t> m_freeLevels[MAX_LEVELS + 1];
+
+    // bounding spheres as SoA for the distance pass
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_radius;
+    // selected level
+    std::vector<uint8_t> m_current;
+
+    std::vector<uint32_t> m_lists[MAX_LEVELS];
+    uint32_t m_levelCount = 0;
+    // work buffer
+    std::vector<float> m_distances;
+
+    uint32_t AllocateLevels(uint32_t count)
+    {
+        auto &free = m_freeLevels[count];
+        if (!free.empty())
+        {
+            auto first = free.back();
+            free.pop_back();
+            return first;
+        }
+        auto first = static_cast<uint32_t>(m_levels.size());
+        m_levels.resize(m_levels.size() + count);
+        return first;
+    }
+
+    void ComputeDistances(const CameraState &camera, std::span<const uint32_t> objects)
+    {
+        // distance to the sphere. the camera inside is near 0 and gets the finest level
+        auto cx = camera.position[0];
+        auto cy = camera.position[1];
+        auto cz = camera.position[2];
+        m_distances.resize(m_x.size());
+        if (objects.empty())
+        {
+            for (size_t i = 0; i < m_x.size(); ++i)
+            {
+                auto dx = m_x[i] - cx;
+                auto dy = m_y[i] - cy;
+                auto dz = m_z[i] - cz;
+                m_distances[i] = std::sqrt(dx * dx + dy * dy + dz * dz) - m_radius[i];
+            }
+        }
+        else
+        {
+            for (auto i : objects)
+            {
+                auto dx = m_x[i] - cx;
+                auto dy = m_y[i] - cy;
+                auto dz = m_z[i] - cz;
+                m_distances[i] = std::sqrt(dx * dx + dy * dy + dz * dz) - m_radius[i];
+            }
+        }
+    }
+
+    void SelectObject(uint32_t id, float pixelsPerError, float coarserPixelsPerError)
+    {
+        auto &object = m_objects[id];
+        auto levels = m_levels.data() + object.firstLevel;
+        auto d = std::max(m_distances[id], 1e-6f);
+
+        // error * scale / d <= threshold
+        auto current = std::min<uint32_t>(m_current[id], object.levelCount - 1);
+        uint32_t level = current;
+        if (levels[current].error * pixelsPerError > d)
+        {
+            // finer
+            while (level > 0 && levels[level].error * pixelsPerError > d)
+            {
+                --level;
+            }
+        }
+        else
+        {
+            // coarser with the margin
+            while (level + 1 < object.levelCount && levels[level + 1].error * coarserPixelsPerError <= d)
+            {
+                ++level;
+            }
+        }
+        m_current[id] = static_cast<uint8_t>(level);
+        m_lists[level].push_back(id);
+    }
+
+public:
+    // pixels
+    float Threshold = 1.0f;
+    // 0 to 1
+    float Hysteresis = 0.2f;
+
+    size_t ObjectCount() const
+    {
+        return m_objects.size() - m_freeObjects.size();
+    }
+
+    // levels from the finest. the first level is selected until the next Select
+    uint32_t AddObject(std::span<const LodLevel> levels, const falg::Sphere &bounds)
+    {
+        if (levels.empty() || levels.size() > MAX_LEVELS)
+        {
+            throw std::runtime_error("invalid level count");
+        }
+        for (size_t i = 1; i < levels.size(); ++i)
+        {
+            if (levels[i].error < levels[i - 1].error)
+            {
+                throw std::runtime_error("levels must be from fine to coarse");
+            }
+        }
+
+        uint32_t id;
+        if (m_freeObjects.empty())
+        {
+            id = static_cast<uint32_t>(m_objects.size());
+            m_objects.push_back({});
+            m_x.push_back(0);
+            m_y.push_back(0);
+            m_z.push_back(0);
+            m_radius.push_back(0);
+            m_current.push_back(0);
+        }
+        else
+        {
+            id = m_freeObjects.back();
+            m_freeObjects.pop_back();
+        }
+        auto count = static_cast<uint32_t>(levels.size());
+        auto first = AllocateLevels(count);
+        std::copy(levels.begin(), levels.end(), m_levels.begin() + first);
+        m_objects[id] = {first, count};
+        m_current[id] = 0;
+        SetBounds(id, bounds);
+        return id;
+    }
+
+    void RemoveObject(uint32_t id)
+    {
+        if (id >= m_objects.size() || m_objects[id].levelCount == 0)
+        {
+            throw std::runtime_error("object not found");
+        }
+        auto &object = m_objects[id];
+        m_freeLevels[object.levelCount].push_back(object.firstLevel);
+        object.levelCount = 0;
+        m_freeObjects.push_back(id);
+    }
+
+    // world bounds of the object
+    void SetBounds(uint32_t id, const falg::Sphere &bounds)
+    {
+        m_x[id] = bounds.center[0];
+        m_y[id] = bounds.center[1];
+        m_z[id] = bounds.center[2];
+        m_radius[id] = std::max(bounds.radius, 0.0f);
+    }
+
+    std::span<const LodLevel> Levels(uint32_t id) const
+    {
+        auto &object = m_objects[id];
+        return {m_levels.data() + object.firstLevel, object.levelCount};
+    }
+
+    // selected level
+    uint32_t Level(uint32_t id) const
+    {
+        return m_current[id];
+    }
+
+    // mesh of the selected level
+    uint32_t Mesh(uint32_t id) const
+    {
+        return m_levels[m_objects[id].firstLevel + m_current[id]].mesh;
+    }
+
+    // projected error of a level in pixels
+    float ProjectedError(const CameraState &camera, uint32_t id, uint32_t level) const
+    {
+        auto dx = m_x[id] - camera.position[0];
+        auto dy = m_y[id] - camera.position[1];
+        auto dz = m_z[id] - camera.position[2];
+        auto d = std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - m_radius[id], 1e-6f);
+        return Levels(id)[level].error * camera.viewportHeight / (2 * std::tan(camera.fovYRadians / 2) * d);
+    }
+
+    ///
+    /// select the level of the objects and fill the draw lists.
+    /// objects is the result of the culling. empty for all objects
+    ///
+    void Select(const CameraState &camera, std::span<const uint32_t> objects = {})
+    {
+        for (auto &list : m_lists)
+        {
+            list.clear();
+        }
+        m_levelCount = 0;
+        if (!(Threshold > 0))
+        {
+            throw std::runtime_error("invalid threshold");
+        }
+        ComputeDistances(camera, objects);
+
+        // pixels per world unit at distance 1, divided by the threshold
+        auto pixelsPerError = camera.viewportHeight / (2 * std::tan(camera.fovYRadians / 2)) / Threshold;
+        auto coarserPixelsPerError = pixelsPerError / std::max(1 - Hysteresis, 1e-6f);
+        if (objects.empty())
+        {
+            for (uint32_t id = 0; id < m_objects.size(); ++id)
+            {
+                if (m_objects[id].levelCount)
+                {
+                    SelectObject(id, pixelsPerError, coarserPixelsPerError);
+                }
+            }
+        }
+        else
+        {
+            for (auto id : objects)
+            {
+                SelectObject(id, pixelsPerError, coarserPixelsPerError);
+            }
+        }
+
+        for (uint32_t level = 0; level < MAX_LEVELS; ++level)
+        {
+            if (!m_lists[level].empty())
+            {
+                m_levelCount = level + 1;
+            }
+        }
+    }
+
+    // 1 + the coarsest selected level
+    uint32_t LevelCount() const
+    {
+        return m_levelCount;
+    }
+
+    // objects of the level. valid after Select
+    std::span<const uint32_t> DrawList(uint32_t level) const
+    {
+        return m_lists[level];
+    }
+};
+
+} // namespace wgut::scene
@@ -0,0 +1,477 @@
+#pragma once
+#include "CameraState.h"
+#include <falg.h>
+#include <array>
+#include <cmath>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+///
+/// loose octree for moving objects.
+///
+/// a cell of depth d has the size worldSize / 2^d and its loose box is twice as large.
+/// an object is stored in the deepest cell whose loose box always contains it,
+/// found from the box center and size without a search.
+///
+/// LooseOctree tree({0, 0, 0}, 1000);
+/// auto id = tree.Insert(aabb);
+/// tree.Update(id, moved); // O(1) while it stays in the same cell
+/// auto count = tree.Query(frustum, visible); // visible is a caller buffer
+///
+/// objects outside of the world are kept in the root and tested by every query.
+/// a node whose loose box is inside the query volume takes its subtree without the object tests.
+/// each visited node is a cache miss, a scan of SoA boxes with falg::CullAABBs is faster
+/// for the frustum of many small objects.
+///
+class LooseOctree
+{
+public:
+    static const uint32_t NONE = UINT32_MAX;
+    static const uint32_t MAX_DEPTH = 10;
+
+private:
+    struct Node
+    {
+        std::array<uint32_t, 8> children;
+        uint32_t parent;
+        // objects in this node as a linked list
+        uint32_t firstObject;
+        // objects in this node and below. an empty branch is skipped and released
+        uint32_t subtreeCount;
+        uint32_t depth;
+        // loose box
+        falg::float3 center;
+        float halfSize;
+
+        // the object center is in the cell and the size selects this depth
+        bool Holds(const falg::float3 &c, float extent, uint32_t maxDepth) const
+        {
+            auto cellHalf = halfSize * 0.5f;
+            if (extent > cellHalf || (extent <= cellHalf * 0.5f && depth < maxDepth))
+            {
+                return false;
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                if (!(c[i] >= center[i] - cellHalf && c[i] < center[i] + cellHalf))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        falg::AABB Bounds() const
+        {
+            return {
+                {center[0] - halfSize, center[1] - halfSize, center[2] - halfSize},
+                {center[0] + halfSize, center[1] + halfSize, center[2] + halfSize},
+            };
+        }
+
+        // loose box of a child from this node. the child node is not read
+        falg::AABB ChildBounds(uint32_t child) const
+        {
+            auto half = halfSize * 0.5f;
+            auto quarter = half * 0.5f;
+            falg::float3 c{
+                center[0] + (child & 1 ? quarter : -quarter),
+                center[1] + (child & 2 ? quarter : -quarter),
+                center[2] + (child & 4 ? quarter : -quarter),
+            };
+            return {
+                {c[0] - half, c[1] - half, c[2] - half},
+                {c[0] + half, c[1] + half, c[2] + half},
+            };
+        }
+    };
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+
+    struct Object
+    {
+        falg::AABB bounds;
+        // NONE if removed
+        uint32_t node;
+        uint32_t prev;
+        uint32_t next;
+    };
+    std::vector<Object> m_objects;
+    std::vector<uint32_t> m_freeObjects;
+
+    falg::float3 m_min;
+    float m_size;
+    uint32_t m_maxDepth;
+
+    // the deepest node that holds aabb. created if not exists
+    uint32_t FindNode(const falg::AABB &aabb)
+    {
+        auto c = aabb.Center();
+        auto e = aabb.Extents();
+        auto extent = std::max(std::max(e[0], e[1]), e[2]);
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!(c[i] >= m_min[i] && c[i] < m_min[i] + m_size))
+            {
+                // outside of the world
+                return 0;
+            }
+        }
+
+        // cell size / 2 >= extent
+        uint32_t depth = m_maxDepth;
+        if (extent > 0)
+        {
+            auto d = std::floor(std::log2(m_size / (2 * extent)));
+            depth = d < 0 ? 0 : std::min(m_maxDepth, static_cast<uint32_t>(d));
+        }
+        std::array<uint32_t, 3> cell;
+        auto cells = 1u << depth;
+        for (int i = 0; i < 3; ++i)
+        {
+            cell[i] = std::min(cells - 1, static_cast<uint32_t>((c[i] - m_min[i]) / m_size * cells));
+        }
+
+        uint32_t node = 0;
+        for (uint32_t level = 1; level <= depth; ++level)
+        {
+            auto shift = depth - level;
+            auto child = ((cell[0] >> shift) & 1) | (((cell[1] >> shift) & 1) << 1) | (((cell[2] >> shift) & 1) << 2);
+            auto next = m_nodes[node].children[child];
+            if (next == NONE)
+            {
+                auto half = m_nodes[node].halfSize * 0.5f;
+                auto quarter = half * 0.5f;
+                auto parentCenter = m_nodes[node].center;
+                Node created{
+                    {NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE},
+                    node,
+                    NONE,
+                    0,
+                    level,
+                    {
+                        parentCenter[0] + (child & 1 ? quarter : -quarter),
+                        parentCenter[1] + (child & 2 ? quarter : -quarter),
+                        parentCenter[2] + (child & 4 ? quarter : -quarter),
+                    },
+                    half,
+                };
+                if (m_freeNodes.empty())
+                {
+                    next = static_cast<uint32_t>(m_nodes.size());
+                    m_nodes.push_back(created);
+                }
+                else
+                {
+                    next = m_freeNodes.back();
+                    m_freeNodes.pop_back();
+                    m_nodes[next] = created;
+                }
+                m_nodes[node].children[child] = next;
+            }
+            node = next;
+        }
+        return node;
+    }
+
+    void Link(uint32_t id, uint32_t node)
+    {
+        auto &object = m_objects[id];
+        object.node = node;
+        object.prev = NONE;
+        object.next = m_nodes[node].firstObject;
+        if (object.next != NONE)
+        {
+            m_objects[object.next].prev = id;
+        }
+        m_nodes[node].firstObject = id;
+        for (auto n = node; n != NONE; n = m_nodes[n].parent)
+        {
+            ++m_nodes[n].subtreeCount;
+        }
+    }
+
+    void Unlink(uint32_t id)
+    {
+        auto &object = m_objects[id];
+        if (object.prev != NONE)
+        {
+            m_objects[object.prev].next = object.next;
+        }
+        else
+        {
+            m_nodes[object.node].firstObject = object.next;
+        }
+        if (object.next != NONE)
+        {
+            m_objects[object.next].prev = object.prev;
+        }
+        for (auto n = object.node; n != NONE; n = m_nodes[n].parent)
+        {
+            --m_nodes[n].subtreeCount;
+        }
+
+        // release the empty branch. the children of an empty node are already released
+        for (auto n = object.node; n != 0 && m_nodes[n].subtreeCount == 0;)
+        {
+            auto parent = m_nodes[n].parent;
+            for (auto &child : m_nodes[parent].children)
+            {
+                if (child == n)
+                {
+                    child = NONE;
+                }
+            }
+            m_freeNodes.push_back(n);
+            n = parent;
+        }
+        object.node = NONE;
+    }
+
+    enum class Overlap
+    {
+        Outside,
+        Partial,
+        Inside,
+    };
+
+    ///
+    /// visit the objects of the nodes that nodeTest does not reject. the root is always visited.
+    /// objectTest(bounds) selects the objects written to dst. stops when dst is full.
+    /// a loose box holds the objects of its subtree, the subtree of an Inside node is taken without tests
+    ///
+    template <typename N, typename O>
+    size_t Traverse(const N &nodeTest, const O &objectTest, std::span<uint32_t> dst) const
+    {
+        struct Entry
+        {
+            uint32_t node;
+            bool inside;
+        };
+        size_t count = 0;
+        std::array<Entry, 8 * MAX_DEPTH + 1> stack;
+        uint32_t sp = 0;
+        stack[sp++] = {0, false};
+        while (sp > 0)
+        {
+            auto entry = stack[--sp];
+            auto &node = m_nodes[entry.node];
+            for (auto id = node.firstObject; id != NONE; id = m_objects[id].next)
+            {
+                if (entry.inside || objectTest(m_objects[id].bounds))
+                {
+                    if (count == dst.size())
+                    {
+                        return count;
+                    }
+                    dst[count++] = id;
+                }
+            }
+            // an empty branch is released, a child is not empty
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                auto child = node.children[i];
+                if (child == NONE)
+                {
+                    continue;
+                }
+                if (entry.inside)
+                {
+                    stack[sp++] = {child, true};
+                    continue;
+                }
+                auto overlap = nodeTest(node.ChildBounds(i));
+                if (overlap != Overlap::Outside)
+                {
+                    stack[sp++] = {child, overlap == Overlap::Inside};
+                }
+            }
+        }
+        return count;
+    }
+
+public:
+    // the cube [min, min + size) is subdivided
+    LooseOctree(const falg::float3 &min, float size, uint32_t maxDepth = 8)
+        : m_min(min), m_size(size), m_maxDepth(std::min(maxDepth, MAX_DEPTH))
+    {
+        if (!(size > 0))
+        {
+            throw std::runtime_error("invalid size");
+        }
+        auto half = size * 0.5f;
+        m_nodes.push_back({
+            {NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE},
+            NONE,
+            NONE,
+            0,
+            0,
+            {min[0] + half, min[1] + half, min[2] + half},
+            size,
+        });
+    }
+
+    size_t Size() const
+    {
+        return m_objects.size() - m_freeObjects.size();
+    }
+
+    size_t NodeCount() const
+    {
+        return m_nodes.size() - m_freeNodes.size();
+    }
+
+    uint32_t Insert(const falg::AABB &aabb)
+    {
+        uint32_t id;
+        if (m_freeObjects.empty())
+        {
+            id = static_cast<uint32_t>(m_objects.size());
+            m_objects.push_back({});
+        }
+        else
+        {
+            id = m_freeObjects.back();
+            m_freeObjects.pop_back();
+        }
+        m_objects[id].bounds = aabb;
+        Link(id, FindNode(aabb));
+        return id;
+    }
+
+    // move to another node only if the cell changed
+    void Update(uint32_t id, const falg::AABB &aabb)
+    {
+        auto &object = m_objects[id];
+        if (object.node == NONE)
+        {
+            throw std::runtime_error("object not found");
+        }
+        object.bounds = aabb;
+        auto e = aabb.Extents();
+        if (object.node != 0 && m_nodes[object.node].Holds(aabb.Center(), std::max(std::max(e[0], e[1]), e[2]), m_maxDepth))
+        {
+            return;
+        }
+        // the new node may be the same
+        Unlink(id);
+        Link(id, FindNode(aabb));
+    }
+
+    void Remove(uint32_t id)
+    {
+        if (id >= m_objects.size() || m_objects[id].node == NONE)
+        {
+            throw std::runtime_error("object not found");
+        }
+        Unlink(id);
+        m_freeObjects.push_back(id);
+    }
+
+    const falg::AABB &Bounds(uint32_t id) const
+    {
+        return m_objects[id].bounds;
+    }
+
+    // visible objects. returns the count written to dst
+    size_t Query(const falg::Frustum &frustum, std::span<uint32_t> dst) const
+    {
+        auto nodeTest = [&frustum](const falg::AABB &aabb) {
+            auto overlap = Overlap::Inside;
+            for (auto &p : frustum.planes)
+            {
+                // the corners farthest and nearest along the plane normal
+                auto x = p[0] >= 0 ? aabb.max[0] : aabb.min[0];
+                auto y = p[1] >= 0 ? aabb.max[1] : aabb.min[1];
+                auto z = p[2] >= 0 ? aabb.max[2] : aabb.min[2];
+                if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0)
+                {
+                    return Overlap::Outside;
+                }
+                x = p[0] >= 0 ? aabb.min[0] : aabb.max[0];
+                y = p[1] >= 0 ? aabb.min[1] : aabb.max[1];
+                z = p[2] >= 0 ? aabb.min[2] : aabb.max[2];
+                if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0)
+                {
+                    overlap = Overlap::Partial;
+                }
+            }
+            return overlap;
+        };
+        auto objectTest = [&frustum](const falg::AABB &aabb) { return frustum.ContainsAABB(aabb.min, aabb.max); };
+        return Traverse(nodeTest, objectTest, dst);
+    }
+
+    size_t Query(const CameraState &camera, std::span<uint32_t> dst, PerspectiveTypes type = PerspectiveTypes::D3D) const
+    {
+        return Query(CameraFrustum(camera, type), dst);
+    }
+
+    // objects whose box overlaps the sphere
+    size_t Query(const falg::float3 &center, float radius, std::span<uint32_t> dst) const
+    {
+        auto objectTest = [&center, radius](const falg::AABB &aabb) {
+            // squared distance from the center to the box
+            float d = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                auto v = std::max(std::max(aabb.min[i] - center[i], 0.0f), center[i] - aabb.max[i]);
+                d += v * v;
+            }
+            return d <= radius * radius;
+        };
+        auto nodeTest = [&center, radius, &objectTest](const falg::AABB &aabb) {
+            if (!objectTest(aabb))
+            {
+                return Overlap::Outside;
+            }
+            // the farthest corner is in the sphere
+            float d = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                auto v = std::max(center[i] - aabb.min[i], aabb.max[i] - center[i]);
+                d += v * v;
+            }
+            return d <= radius * radius ? Overlap::Inside : Overlap::Partial;
+        };
+        return Traverse(nodeTest, objectTest, dst);
+    }
+
+    size_t Query(const falg::AABB &bounds, std::span<uint32_t> dst) const
+    {
+        auto objectTest = [&bounds](const falg::AABB &aabb) { return aabb.Overlaps(bounds); };
+        auto nodeTest = [&bounds](const falg::AABB &aabb) {
+            if (!aabb.Overlaps(bounds))
+            {
+                return Overlap::Outside;
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                if (aabb.min[i] < bounds.min[i] || aabb.max[i] > bounds.max[i])
+                {
+                    return Overlap::Partial;
+                }
+            }
+            return Overlap::Inside;
+        };
+        return Traverse(nodeTest, objectTest, dst);
+    }
+
+    // objects whose box the ray hits before maxT. not sorted
+    size_t Query(const falg::Ray &ray, std::span<uint32_t> dst, float maxT = std::numeric_limits<float>::infinity()) const
+    {
+        auto objectTest = [&ray, maxT](const falg::AABB &aabb) {
+            auto t = ray >> aabb;
+            return !std::isinf(t) && t <= maxT;
+        };
+        auto nodeTest = [&objectTest](const falg::AABB &aabb) { return objectTest(aabb) ? Overlap::Partial : Overlap::Outside; };
+        return Traverse(nodeTest, objectTest, dst);
+    }
+};
+
+} // namespace wgut::scene
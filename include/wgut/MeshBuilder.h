@@ -1,176 +1,239 @@
-#pragma once
-#include <span>
-#include <stdexcept>
-#include <stdint.h>
-#include <assert.h>
-
-namespace wgut::mesh
-{
-
-struct MeshBuilder
-{
-    uint32_t VertexStride = 0;
-    std::vector<uint8_t> VerticesData;
-
-    uint32_t IndexStride = 0;
-    std::vector<uint8_t> IndicesData;
-
-    MeshBuilder(uint32_t vertexStride, uint32_t indexStride)
-        : VertexStride(vertexStride), IndexStride(indexStride)
-    {
-    }
-
-    template <typename VERTEX>
-    void AppendVertex(const VERTEX v)
-    {
-        VertexStride = sizeof(VERTEX);
-        VerticesData.insert(VerticesData.end(), (const uint8_t *)&v, (const uint8_t *)&v + sizeof(VERTEX));
-    }
-
-    void AppendIndex(uint32_t i)
-    {
-        switch (IndexStride)
-        {
-        case 2:
-        {
-            auto index = static_cast<uint16_t>(i);
-            IndicesData.insert(IndicesData.end(), (const uint8_t *)&index, (const uint8_t *)&index + 2);
-        }
-        break;
-
-        case 4:
-        {
-            auto index = static_cast<uint32_t>(i);
-            IndicesData.insert(IndicesData.end(), (const uint8_t *)&index, (const uint8_t *)&index + 4);
-        }
-        break;
-
-        default:
-            throw std::runtime_error("not implemented");
-        }
-    }
-
-    template <typename VERTEX>
-    void PushQuad(const VERTEX &v0, const VERTEX &v1, const VERTEX &v2, const VERTEX &v3)
-    {
-        // assert(VertexLayout.Stride() == sizeof(VERTEX));
-
-        auto i = static_cast<uint32_t>(VerticesData.size() / sizeof(VERTEX));
-        AppendVertex(v0);
-        AppendVertex(v1);
-        AppendVertex(v2);
-        AppendVertex(v3);
-        // t0
-        AppendIndex(i);
-        AppendIndex(i + 1);
-        AppendIndex(i + 2);
-        // t1
-        AppendIndex(i + 2);
-        AppendIndex(i + 3);
-        AppendIndex(i);
-    }
-};
-
-struct Quad
-{
-    struct float2
-    {
-        float x;
-        float y;
-    };
-    struct Vertex
-    {
-        float2 position;
-        float2 uv;
-    };
-
-    static MeshBuilder Create()
-    {
-        auto builder = MeshBuilder(sizeof(Vertex), 2);
-        // clock wise
-        builder.PushQuad(
-            Vertex{{-1, 1}, {0, 0}},
-            Vertex{{1, 1}, {1, 0}},
-            Vertex{{1, -1}, {1, 1}},
-            Vertex{{-1, -1}, {0, 1}}
-            );
-        return builder;
-    }
-};
-
-struct Cube
-{
-    struct float2
-    {
-        float x;
-        float y;
-    };
-    struct float3
-    {
-        float x;
-        float y;
-        float z;
-    };
-    struct Vertex
-    {
-        float3 position;
-        float2 uv;
-    };
-
-    static MeshBuilder Create()
-    {
-        float3 positions[] = {
-            {-1.0f, -1.0f, -1.0f},
-            {1.0f, -1.0f, -1.0f},
-            {1.0f, 1.0f, -1.0f},
-            {-1.0f, 1.0f, -1.0f},
-            {-1.0f, -1.0f, 1.0f},
-            {1.0f, -1.0f, 1.0f},
-            {1.0f, 1.0f, 1.0f},
-            {-1.0f, 1.0f, 1.0f},
-        };
-
-        float2 uv[] = {
-            {0.0f, 1.0f},
-            {1.0f, 1.0f},
-            {1.0f, 0.0f},
-            {0.0f, 0.0f},
-        };
-
-        auto builder = MeshBuilder(sizeof(Vertex), 2);
-        builder.PushQuad(
-            Vertex{positions[0], uv[0]},
-            Vertex{positions[1], uv[1]},
-            Vertex{positions[2], uv[2]},
-            Vertex{positions[3], uv[3]});
-        builder.PushQuad(
-            Vertex{positions[1], uv[0]},
-            Vertex{positions[5], uv[1]},
-            Vertex{positions[6], uv[2]},
-            Vertex{positions[2], uv[3]});
-        builder.PushQuad(
-            Vertex{positions[5], uv[0]},
-            Vertex{positions[4], uv[1]},
-            Vertex{positions[7], uv[2]},
-            Vertex{positions[6], uv[3]});
-        builder.PushQuad(
-            Vertex{positions[4], uv[0]},
-            Vertex{positions[0], uv[1]},
-            Vertex{positions[3], uv[2]},
-            Vertex{positions[7], uv[3]});
-        builder.PushQuad(
-            Vertex{positions[3], uv[0]},
-            Vertex{positions[2], uv[1]},
-            Vertex{positions[6], uv[2]},
-            Vertex{positions[7], uv[3]});
-        builder.PushQuad(
-            Vertex{positions[0], uv[0]},
-            Vertex{positions[4], uv[1]},
-            Vertex{positions[5], uv[2]},
-            Vertex{positions[1], uv[3]});
-
-        return builder;
-    }
-};
-
-} // namespace wgut
+#pragma once
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <falg_dispatch.h>
+
+namespace wgut::mesh
+{
+
+struct MeshBuilder
+{
+    uint32_t VertexStride = 0;
+    std::vector<uint8_t> VerticesData;
+
+    uint32_t IndexStride = 0;
+    std::vector<uint8_t> IndicesData;
+
+    MeshBuilder(uint32_t vertexStride, uint32_t indexStride)
+        : VertexStride(vertexStride), IndexStride(indexStride)
+    {
+    }
+
+    template <typename VERTEX>
+    void AppendVertex(const VERTEX v)
+    {
+        VertexStride = sizeof(VERTEX);
+        VerticesData.insert(VerticesData.end(), (const uint8_t *)&v, (const uint8_t *)&v + sizeof(VERTEX));
+    }
+
+    void AppendIndex(uint32_t i)
+    {
+        switch (IndexStride)
+        {
+        case 2:
+        {
+            auto index = static_cast<uint16_t>(i);
+            IndicesData.insert(IndicesData.end(), (const uint8_t *)&index, (const uint8_t *)&index + 2);
+        }
+        break;
+
+        case 4:
+        {
+            auto index = static_cast<uint32_t>(i);
+            IndicesData.insert(IndicesData.end(), (const uint8_t *)&index, (const uint8_t *)&index + 4);
+        }
+        break;
+
+        default:
+            throw std::runtime_error("not implemented");
+        }
+    }
+
+    // float vertices to half. attributes are the float count of each vertex attribute, {3, 2} for position, uv.
+    // 2 to R16G16_FLOAT. 3, 4 to R16G16B16A16_FLOAT, the padding w is 1.
+    // see wgut::shader::InputLayout::UseHalf
+    MeshBuilder ToHalf(std::span<const uint32_t> attributes) const
+    {
+        uint32_t floats = 0;
+        uint32_t halves = 0;
+        for (auto count : attributes)
+        {
+            switch (count)
+            {
+            case 2:
+                halves += 2;
+                break;
+
+            case 3:
+            case 4:
+                halves += 4;
+                break;
+
+            default:
+                throw std::runtime_error("not implemented");
+            }
+            floats += count;
+        }
+        if (floats * 4 != VertexStride)
+        {
+            throw std::runtime_error("attributes not match VertexStride");
+        }
+
+        // pad to the half layout, then convert all at once
+        auto vertexCount = VerticesData.size() / VertexStride;
+        std::vector<float> padded(vertexCount * halves);
+        auto src = VerticesData.data();
+        auto dst = padded.data();
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            for (auto count : attributes)
+            {
+                memcpy(dst, src, count * 4);
+                src += count * 4;
+                if (count == 3)
+                {
+                    dst[3] = 1.0f;
+                    dst += 4;
+                }
+                else
+                {
+                    dst += count;
+                }
+            }
+        }
+
+        MeshBuilder half(halves * 2, IndexStride);
+        half.IndicesData = IndicesData;
+        half.VerticesData.resize(padded.size() * 2);
+        falg::dispatch::FloatToHalf(padded, std::span((uint16_t *)half.VerticesData.data(), padded.size()));
+        return half;
+    }
+
+    template <typename VERTEX>
+    void PushQuad(const VERTEX &v0, const VERTEX &v1, const VERTEX &v2, const VERTEX &v3)
+    {
+        // assert(VertexLayout.Stride() == sizeof(VERTEX));
+
+        auto i = static_cast<uint32_t>(VerticesData.size() / sizeof(VERTEX));
+        AppendVertex(v0);
+        AppendVertex(v1);
+        AppendVertex(v2);
+        AppendVertex(v3);
+        // t0
+        AppendIndex(i);
+        AppendIndex(i + 1);
+        AppendIndex(i + 2);
+        // t1
+        AppendIndex(i + 2);
+        AppendIndex(i + 3);
+        AppendIndex(i);
+    }
+};
+
+struct Quad
+{
+    struct float2
+    {
+        float x;
+        float y;
+    };
+    struct Vertex
+    {
+        float2 position;
+        float2 uv;
+    };
+
+    static MeshBuilder Create()
+    {
+        auto builder = MeshBuilder(sizeof(Vertex), 2);
+        // clock wise
+        builder.PushQuad(
+            Vertex{{-1, 1}, {0, 0}},
+            Vertex{{1, 1}, {1, 0}},
+            Vertex{{1, -1}, {1, 1}},
+            Vertex{{-1, -1}, {0, 1}}
+            );
+        return builder;
+    }
+};
+
+struct Cube
+{
+    struct float2
+    {
+        float x;
+        float y;
+    };
+    struct float3
+    {
+        float x;
+        float y;
+        float z;
+    };
+    struct Vertex
+    {
+        float3 position;
+        float2 uv;
+    };
+
+    static MeshBuilder Create()
+    {
+        float3 positions[] = {
+            {-1.0f, -1.0f, -1.0f},
+            {1.0f, -1.0f, -1.0f},
+            {1.0f, 1.0f, -1.0f},
+            {-1.0f, 1.0f, -1.0f},
+            {-1.0f, -1.0f, 1.0f},
+            {1.0f, -1.0f, 1.0f},
+            {1.0f, 1.0f, 1.0f},
+            {-1.0f, 1.0f, 1.0f},
+        };
+
+        float2 uv[] = {
+            {0.0f, 1.0f},
+            {1.0f, 1.0f},
+            {1.0f, 0.0f},
+            {0.0f, 0.0f},
+        };
+
+        auto builder = MeshBuilder(sizeof(Vertex), 2);
+        builder.PushQuad(
+            Vertex{positions[0], uv[0]},
+            Vertex{positions[1], uv[1]},
+            Vertex{positions[2], uv[2]},
+            Vertex{positions[3], uv[3]});
+        builder.PushQuad(
+            Vertex{positions[1], uv[0]},
+            Vertex{positions[5], uv[1]},
+            Vertex{positions[6], uv[2]},
+            Vertex{positions[2], uv[3]});
+        builder.PushQuad(
+            Vertex{positions[5], uv[0]},
+            Vertex{positions[4], uv[1]},
+            Vertex{positions[7], uv[2]},
+            Vertex{positions[6], uv[3]});
+        builder.PushQuad(
+            Vertex{positions[4], uv[0]},
+            Vertex{positions[0], uv[1]},
+            Vertex{positions[3], uv[2]},
+            Vertex{positions[7], uv[3]});
+        builder.PushQuad(
+            Vertex{positions[3], uv[0]},
+            Vertex{positions[2], uv[1]},
+            Vertex{positions[6], uv[2]},
+            Vertex{positions[7], uv[3]});
+        builder.PushQuad(
+            Vertex{positions[0], uv[0]},
+            Vertex{positions[4], uv[1]},
+            Vertex{positions[5], uv[2]},
+            Vertex{positions[1], uv[3]});
+
+        return builder;
+    }
+};
+
+} // namespace wgut
@@ -0,0 +1,135 @@
+#pragma once
+#include "Bvh.h"
+#include <falg.h>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+struct MeshHit
+{
+    float t = std::numeric_limits<float>::infinity();
+    // index / 3 in the index buffer. (max) for the windows.h macro
+    uint32_t triangle = (std::numeric_limits<uint32_t>::max)();
+    // barycentric weights of the second and the third vertex
+    float u = 0;
+    float v = 0;
+
+    bool IsHit() const
+    {
+        return triangle != (std::numeric_limits<uint32_t>::max)();
+    }
+};
+
+///
+/// Bvh over the triangles of an indexed mesh.
+/// triangles are copied in leaf order, a leaf reads one contiguous range.
+///
+/// MeshBvh bvh;
+/// bvh.Build(vertices, indices, &Vertex::position);
+/// auto hit = bvh.Intersect(ray);
+/// bvh.Refit(deformed, indices, &Vertex::position); // same indices
+///
+class MeshBvh
+{
+    Bvh m_bvh;
+    // in leaf order
+    std::vector<falg::Triangle> m_triangles;
+    std::vector<falg::AABB> m_bounds;
+
+    template <typename V>
+    void Gather(std::span<const V> vertices, std::span<const uint32_t> indices, falg::float3 V::*position)
+    {
+        auto count = indices.size() / 3;
+        m_bounds.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            falg::AABB aabb;
+            aabb.Expand(vertices[indices[i * 3]].*position);
+            aabb.Expand(vertices[indices[i * 3 + 1]].*position);
+            aabb.Expand(vertices[indices[i * 3 + 2]].*position);
+            m_bounds[i] = aabb;
+        }
+    }
+
+    template <typename V>
+    void CopyTriangles(std::span<const V> vertices, std::span<const uint32_t> indices, falg::float3 V::*position)
+    {
+        auto order = m_bvh.Indices();
+        m_triangles.resize(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            auto t = order[i] * 3;
+            m_triangles[i] = {
+                vertices[indices[t]].*position,
+                vertices[indices[t + 1]].*position,
+                vertices[indices[t + 2]].*position,
+            };
+        }
+    }
+
+public:
+    const Bvh &Tree() const
+    {
+        return m_bvh;
+    }
+
+    size_t TriangleCount() const
+    {
+        return m_triangles.size();
+    }
+
+    falg::AABB Bounds() const
+    {
+        return m_bvh.Bounds();
+    }
+
+    template <typename V>
+    void Build(std::span<const V> vertices, std::span<const uint32_t> indices, falg::float3 V::*position,
+               uint32_t maxLeafSize = 4, uint32_t binCount = 16)
+    {
+        Gather(vertices, indices, position);
+        m_bvh.Build(m_bounds, maxLeafSize, binCount);
+        CopyTriangles(vertices, indices, position);
+    }
+
+    // moved vertices. the tree is kept and gets looser. Build again after large deformation
+    template <typename V>
+    void Refit(std::span<const V> vertices, std::span<const uint32_t> indices, falg::float3 V::*position)
+    {
+        if (indices.size() / 3 != m_triangles.size())
+        {
+            throw std::runtime_error("triangle count changed");
+        }
+        Gather(vertices, indices, position);
+        m_bvh.Refit(m_bounds);
+        CopyTriangles(vertices, indices, position);
+    }
+
+    // nearest hit closer than maxT
+    MeshHit Intersect(const falg::Ray &ray, float maxT = std::numeric_limits<float>::infinity()) const
+    {
+        MeshHit hit;
+        auto t = maxT;
+        auto order = m_bvh.Indices();
+        m_bvh.Traverse(ray, t, [&](uint32_t first, uint32_t count) {
+            for (auto i = first; i < first + count; ++i)
+            {
+                float u = 0;
+                float v = 0;
+                auto d = falg::IntersectTriangle(ray, m_triangles[i], u, v);
+                if (d < t)
+                {
+                    t = d;
+                    hit = {d, order[i], u, v};
+                }
+            }
+        });
+        return hit;
+    }
+};
+
+} // namespace wgut::scene
@@ -0,0 +1,805 @@
+#pragma once
+#include "MeshBuilder.h"
+#include <falg.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::mesh
+{
+
+namespace detail
+{
+// spatial hash of integer cells. open addressing, each slot is the head of a linked list of vertices
+class cell_hash
+{
+    struct Slot
+    {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+        // UINT32_MAX if empty
+        uint32_t head;
+    };
+    std::vector<Slot> m_slots;
+    size_t m_mask = 0;
+
+    static size_t Hash(int64_t x, int64_t y, int64_t z)
+    {
+        // large primes. see "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+        return static_cast<size_t>(static_cast<uint64_t>(x) * 73856093 ^ static_cast<uint64_t>(y) * 19349663 ^ static_cast<uint64_t>(z) * 83492791);
+    }
+
+public:
+    explicit cell_hash(size_t count)
+    {
+        size_t capacity = 16;
+        while (capacity < count * 2)
+        {
+            capacity *= 2;
+        }
+        m_slots.resize(capacity, {0, 0, 0, UINT32_MAX});
+        m_mask = capacity - 1;
+    }
+
+    // the list head of the cell. UINT32_MAX if not found
+    uint32_t Find(int64_t x, int64_t y, int64_t z) const
+    {
+        for (auto i = Hash(x, y, z) & m_mask;; i = (i + 1) & m_mask)
+        {
+            auto &slot = m_slots[i];
+            if (slot.head == UINT32_MAX)
+            {
+                return UINT32_MAX;
+            }
+            if (slot.x == x && slot.y == y && slot.z == z)
+            {
+                return slot.head;
+            }
+        }
+    }
+
+    // returns the previous head
+    uint32_t Push(int64_t x, int64_t y, int64_t z, uint32_t head)
+    {
+        for (auto i = Hash(x, y, z) & m_mask;; i = (i + 1) & m_mask)
+        {
+            auto &slot = m_slots[i];
+            if (slot.head == UINT32_MAX)
+            {
+                slot = {x, y, z, head};
+                return UINT32_MAX;
+            }
+            if (slot.x == x && slot.y == y && slot.z == z)
+            {
+                auto next = slot.head;
+                slot.head = head;
+                return next;
+            }
+        }
+    }
+};
+
+template <typename F>
+size_t weld_vertices(size_t count, const F &position, std::span<uint32_t> remap, double epsilon)
+{
+    if (remap.size() < count)
+    {
+        throw std::runtime_error("remap is too small");
+    }
+    if (!(epsilon > 0))
+    {
+        throw std::runtime_error("invalid epsilon");
+    }
+
+    auto size = 4 * epsilon;
+    cell_hash hash(count);
+    // linked list of the first vertices in a cell. descending order
+    std::vector<uint32_t> next(count);
+    size_t groups = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto &v1 = position(i);
+        if (!std::isfinite(v1[0]) || !std::isfinite(v1[1]) || !std::isfinite(v1[2]))
+        {
+            // never closer than epsilon
+            remap[i] = i;
+            ++groups;
+            continue;
+        }
+
+        int64_t cell[3];
+        int64_t side[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            auto c = v1[k] / size;
+            auto f = std::floor(c);
+            cell[k] = static_cast<int64_t>(f);
+            // the neighbor cell on the nearer side. the cell is 4 times epsilon
+            side[k] = c - f < 0.5 ? -1 : 1;
+        }
+
+        auto found = UINT32_MAX;
+        for (int n = 0; n < 8; ++n)
+        {
+            auto head = hash.Find(cell[0] + (n & 1 ? side[0] : 0), cell[1] + (n & 2 ? side[1] : 0), cell[2] + (n & 4 ? side[2] : 0));
+            for (auto j = head; j != UINT32_MAX; j = next[j])
+            {
+                if (found != UINT32_MAX && j < found)
+                {
+                    // the rest are older
+                    break;
+                }
+                auto &v0 = position(j);
+                if (falg::Length(v1 - v0) < epsilon)
+                {
+                    found = j;
+                    break;
+                }
+            }
+        }
+
+        if (found == UINT32_MAX)
+        {
+            remap[i] = i;
+            next[i] = hash.Push(cell[0], cell[1], cell[2], i);
+            ++groups;
+        }
+        else
+        {
+            remap[i] = found;
+        }
+    }
+    return groups;
+}
+} // namespace detail
+
+///
+/// find the coincident vertices. remap[i] is the first vertex of the group of vertex i, remap[i] == i for the first ones.
+///
+/// vertices are visited in order. a vertex joins the last group whose first vertex is closer than epsilon,
+/// or starts a new group. the first vertices are kept in a spatial hash and a vertex looks up the 8 cells around it.
+/// expected O(n).
+///
+/// std::vector<uint32_t> remap(vertices.size());
+/// auto groups = WeldVertices(std::span<const Vertex>(vertices), &Vertex::position, remap);
+///
+/// returns the number of groups
+///
+template <typename V>
+size_t WeldVertices(std::span<const V> vertices, falg::float3 V::*position, std::span<uint32_t> remap, double epsilon = 0.0001)
+{
+    return detail::weld_vertices(
+        vertices.size(), [vertices, position](size_t i) -> const falg::float3 & { return vertices[i].*position; }, remap, epsilon);
+}
+
+inline size_t WeldVertices(std::span<const falg::float3> positions, std::span<uint32_t> remap, double epsilon = 0.0001)
+{
+    return detail::weld_vertices(
+        positions.size(), [positions](size_t i) -> const falg::float3 & { return positions[i]; }, remap, epsilon);
+}
+
+struct VertexCacheStats
+{
+    // average cache miss ratio. vertex shader runs per triangle, 0.5 to 3
+    float acmr = 0;
+    // average transformed vertex ratio. vertex shader runs per referenced vertex, 1 is the best
+    float atvr = 0;
+};
+
+struct VertexCacheResult
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+///
+/// simulate a FIFO post transform cache of cacheSize vertices
+///
+template <typename T>
+VertexCacheStats AnalyzeVertexCache(std::span<const T> indices, size_t vertexCount, uint32_t cacheSize = 16)
+{
+    if (indices.size() < 3)
+    {
+        return {};
+    }
+    // insertion time of each vertex. 0 is never
+    std::vector<uint32_t> cached(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    size_t referenced = 0;
+    for (auto i : indices)
+    {
+        if (i >= vertexCount)
+        {
+            throw std::runtime_error("index out of range");
+        }
+        if (cached[i] == 0)
+        {
+            ++referenced;
+        }
+        if (time - cached[i] > cacheSize)
+        {
+            cached[i] = time++;
+            ++misses;
+        }
+    }
+    return {
+        static_cast<float>(misses) / (indices.size() / 3),
+        static_cast<float>(misses) / referenced,
+    };
+}
+
+///
+/// reorder triangles for the post transform cache. the triangles keep their winding.
+///
+/// Tipsify. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" Sander, Nehab, Barczak 2007.
+/// the triangles around a fanning vertex are emitted, the next fanning vertex is the one among the emitted vertices
+/// that stays longest in the cache after its remaining triangles. linear time.
+///
+template <typename T>
+void OptimizeVertexCache(std::span<T> indices, size_t vertexCount, uint32_t cacheSize = 16)
+{
+    auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    std::vector<T> input(indices.begin(), indices.begin() + triangleCount * 3);
+
+    // triangles of each vertex
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (auto i : input)
+    {
+        if (i >= vertexCount)
+        {
+            throw std::runtime_error("index out of range");
+        }
+        ++offsets[i + 1];
+    }
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+    // live triangle count
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        live[i] = offsets[i + 1] - offsets[i];
+    }
+    std::vector<uint32_t> adjacency(input.size());
+    {
+        auto cursor = offsets;
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            adjacency[cursor[input[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint32_t> cached(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;
+    deadEnd.reserve(input.size());
+    std::vector<uint32_t> candidates;
+    size_t cursor = 0;
+    size_t written = 0;
+
+    int64_t fanning = 0;
+    while (live[fanning] == 0)
+    {
+        ++fanning;
+    }
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        for (auto j = offsets[fanning]; j < offsets[fanning + 1]; ++j)
+        {
+            auto t = adjacency[j];
+            if (emitted[t])
+            {
+                continue;
+            }
+            emitted[t] = 1;
+            for (int k = 0; k < 3; ++k)
+            {
+                auto v = input[t * 3 + k];
+                indices[written++] = v;
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - cached[v] > cacheSize)
+                {
+                    cached[v] = time++;
+                }
+            }
+        }
+
+        // the candidate that is still in the cache after its live triangles, the oldest first
+        fanning = -1;
+        int64_t best = -1;
+        for (auto v : candidates)
+        {
+            if (live[v] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cached[v] + 2 * live[v] <= cacheSize)
+            {
+                priority = time - cached[v];
+            }
+            if (priority > best)
+            {
+                best = priority;
+                fanning = v;
+            }
+        }
+        if (fanning < 0)
+        {
+            // dead end. the recently used vertices, then in input order
+            while (!deadEnd.empty())
+            {
+                auto v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0)
+                {
+                    fanning = v;
+                    break;
+                }
+            }
+            while (fanning < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0)
+                {
+                    fanning = cursor;
+                }
+                ++cursor;
+            }
+        }
+    }
+}
+
+namespace detail
+{
+// f(std::span<uint16_t>) or f(std::span<uint32_t>) by IndexStride
+template <typename F>
+void with_indices(MeshBuilder &mesh, const F &f)
+{
+    switch (mesh.IndexStride)
+    {
+    case 2:
+        f(std::span((uint16_t *)mesh.IndicesData.data(), mesh.IndicesData.size() / 2));
+        break;
+
+    case 4:
+        f(std::span((uint32_t *)mesh.IndicesData.data(), mesh.IndicesData.size() / 4));
+        break;
+
+    default:
+        throw std::runtime_error("not implemented");
+    }
+}
+
+inline size_t vertex_count(const MeshBuilder &mesh)
+{
+    if (mesh.VertexStride == 0)
+    {
+        throw std::runtime_error("no VertexStride");
+    }
+    return mesh.VerticesData.size() / mesh.VertexStride;
+}
+
+// the float3 at positionOffset of each vertex
+inline std::vector<falg::float3> positions(const MeshBuilder &mesh, uint32_t positionOffset)
+{
+    auto count = vertex_count(mesh);
+    if (mesh.VertexStride < positionOffset + sizeof(falg::float3))
+    {
+        throw std::runtime_error("invalid position offset");
+    }
+    std::vector<falg::float3> positions(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        memcpy(&positions[i], mesh.VerticesData.data() + i * mesh.VertexStride + positionOffset, sizeof(falg::float3));
+    }
+    return positions;
+}
+} // namespace detail
+
+// 16 or 32 bit indices of the mesh in place
+inline VertexCacheResult OptimizeVertexCache(MeshBuilder &mesh, uint32_t cacheSize = 16)
+{
+    auto vertexCount = detail::vertex_count(mesh);
+    VertexCacheResult result;
+    detail::with_indices(mesh, [&](auto indices) {
+        using T = typename decltype(indices)::value_type;
+        result.before = AnalyzeVertexCache<T>(indices, vertexCount, cacheSize);
+        OptimizeVertexCache(indices, vertexCount, cacheSize);
+        result.after = AnalyzeVertexCache<T>(indices, vertexCount, cacheSize);
+    });
+    return result;
+}
+
+// the winding of the front faces seen from the front.
+// Clockwise is the d3d11 default rasterizer state and the MeshBuilder shapes,
+// CounterClockwise has Cross(p1 - p0, p2 - p0) as the outward normal like geometry_mesh
+enum class FrontFace
+{
+    Clockwise,
+    CounterClockwise,
+};
+
+namespace detail
+{
+// toward the front side
+inline falg::float3 front_normal(const falg::float3 &p0, const falg::float3 &p1, const falg::float3 &p2, FrontFace frontFace)
+{
+    auto n = falg::Cross(p1 - p0, p2 - p0);
+    return frontFace == FrontFace::CounterClockwise ? n : n * -1.0f;
+}
+} // namespace detail
+
+struct OverdrawStats
+{
+    // pixels covered by the mesh
+    uint64_t covered = 0;
+    // pixels shaded, passed the depth test in the index order
+    uint64_t shaded = 0;
+
+    // 1 is no overdraw
+    float Overdraw() const
+    {
+        return covered ? static_cast<float>(shaded) / covered : 0;
+    }
+};
+
+struct OverdrawResult
+{
+    OverdrawStats before;
+    OverdrawStats after;
+    size_t clusters = 0;
+};
+
+///
+/// estimate the overdraw on the cpu. the mesh is drawn in the index order with the depth test and back face culling
+/// from the 6 axis directions into a resolution x resolution orthographic view of the bounding box.
+/// frontFace is the winding that is not culled
+///
+template <typename T>
+OverdrawStats AnalyzeOverdraw(std::span<const T> indices, std::span<const falg::float3> positions, FrontFace frontFace,
+                              uint32_t resolution = 256)
+{
+    OverdrawStats stats;
+    falg::AABB aabb;
+    for (auto i : indices)
+    {
+        if (i >= positions.size())
+        {
+            throw std::runtime_error("index out of range");
+        }
+        aabb.Expand(positions[i]);
+    }
+    auto e = aabb.Extents();
+    auto extent = std::max(std::max(e[0], e[1]), e[2]) * 2;
+    if (!(extent > 0))
+    {
+        return stats;
+    }
+    auto scale = resolution / extent;
+    auto center = aabb.Center();
+
+    std::vector<float> depth(resolution * resolution);
+    for (int view = 0; view < 6; ++view)
+    {
+        // looking along -axis or +axis. u is mirrored with the depth to keep the winding
+        auto axis = view % 3;
+        auto u = (axis + 1) % 3;
+        auto v = (axis + 2) % 3;
+        float sign = view < 3 ? 1.0f : -1.0f;
+        std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::infinity());
+        auto project = [&](const falg::float3 &p) {
+            return falg::float3{
+                sign * (p[u] - center[u]) * scale + resolution * 0.5f,
+                (p[v] - center[v]) * scale + resolution * 0.5f,
+                sign * p[axis],
+            };
+        };
+
+        for (size_t t = 0; t + 2 < indices.size(); t += 3)
+        {
+            // the outward Cross(p1 - p0, p2 - p0) is clockwise on the view. swapped to counter clockwise
+            auto swap = frontFace == FrontFace::CounterClockwise;
+            auto p0 = project(positions[indices[t]]);
+            auto p1 = project(positions[indices[swap ? t + 2 : t + 1]]);
+            auto p2 = project(positions[indices[swap ? t + 1 : t + 2]]);
+            auto area = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p2[0] - p0[0]) * (p1[1] - p0[1]);
+            if (!(area > 0))
+            {
+                continue;
+            }
+            auto x0 = std::max(0, static_cast<int>(std::floor(std::min(std::min(p0[0], p1[0]), p2[0]))));
+            auto y0 = std::max(0, static_cast<int>(std::floor(std::min(std::min(p0[1], p1[1]), p2[1]))));
+            auto x1 = std::min(static_cast<int>(resolution), static_cast<int>(std::ceil(std::max(std::max(p0[0], p1[0]), p2[0]))));
+            auto y1 = std::min(static_cast<int>(resolution), static_cast<int>(std::ceil(std::max(std::max(p0[1], p1[1]), p2[1]))));
+            for (auto y = y0; y < y1; ++y)
+            {
+                for (auto x = x0; x < x1; ++x)
+                {
+                    auto px = x + 0.5f;
+                    auto py = y + 0.5f;
+                    // barycentric weights
+                    auto w0 = (p1[0] - px) * (p2[1] - py) - (p2[0] - px) * (p1[1] - py);
+                    auto w1 = (p2[0] - px) * (p0[1] - py) - (p0[0] - px) * (p2[1] - py);
+                    auto w2 = (p0[0] - px) * (p1[1] - py) - (p1[0] - px) * (p0[1] - py);
+                    if (w0 < 0 || w1 < 0 || w2 < 0)
+                    {
+                        continue;
+                    }
+                    auto z = (w0 * p0[2] + w1 * p1[2] + w2 * p2[2]) / area;
+                    auto &d = depth[y * resolution + x];
+                    if (z < d)
+                    {
+                        if (std::isinf(d))
+                        {
+                            ++stats.covered;
+                        }
+                        d = z;
+                        ++stats.shaded;
+                    }
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+///
+/// reorder the clusters of triangles to draw the outer and outward facing ones first. view independent.
+///
+/// the second half of Tipsify. run OptimizeVertexCache first.
+/// the index buffer is cut where the cache is flushed, and where the cache miss ratio of the current cluster
+/// is within threshold times the ratio of the whole cut. a higher threshold makes more, smaller clusters,
+/// better for overdraw and worse for the cache. 1.05 loses about 5% of the cache efficiency.
+/// clusters are sorted by dot(cluster center - mesh center, cluster normal), the largest first.
+/// the normal points to the front side of frontFace.
+///
+/// returns the number of clusters
+///
+template <typename T>
+size_t OptimizeOverdraw(std::span<T> indices, std::span<const falg::float3> positions, FrontFace frontFace,
+                        float threshold = 1.05f, uint32_t cacheSize = 16)
+{
+    auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return 0;
+    }
+    for (auto i : indices)
+    {
+        if (i >= positions.size())
+        {
+            throw std::runtime_error("index out of range");
+        }
+    }
+
+    // the cache misses of a triangle
+    std::vector<uint32_t> cached(positions.size(), 0);
+    uint32_t time = cacheSize + 1;
+    auto misses = [&](size_t t) {
+        uint32_t count = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            auto v = indices[t * 3 + k];
+            if (time - cached[v] > cacheSize)
+            {
+                cached[v] = time++;
+                ++count;
+            }
+        }
+        return count;
+    };
+    auto flush = [&]() {
+        // every cached vertex gets out of the window
+        time += cacheSize + 1;
+    };
+
+    // hard boundaries. a triangle with 3 misses starts a new cut
+    std::vector<uint32_t> hard;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (misses(t) == 3)
+        {
+            hard.push_back(static_cast<uint32_t>(t));
+        }
+    }
+    if (hard.empty() || hard[0] != 0)
+    {
+        hard.insert(hard.begin(), 0);
+    }
+    hard.push_back(static_cast<uint32_t>(triangleCount));
+
+    // soft boundaries in each cut
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        auto begin = hard[h];
+        auto end = hard[h + 1];
+        flush();
+        size_t cutMisses = 0;
+        for (auto t = begin; t < end; ++t)
+        {
+            cutMisses += misses(t);
+        }
+        auto target = static_cast<float>(cutMisses) / (end - begin) * threshold;
+
+        flush();
+        clusters.push_back(begin);
+        size_t clusterMisses = 0;
+        auto clusterBegin = begin;
+        for (auto t = begin; t < end; ++t)
+        {
+            clusterMisses += misses(t);
+            if (t + 1 < end && static_cast<float>(clusterMisses) / (t + 1 - clusterBegin) <= target)
+            {
+                clusters.push_back(t + 1);
+                clusterBegin = t + 1;
+                clusterMisses = 0;
+                flush();
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+    auto clusterCount = clusters.size() - 1;
+
+    // area weighted centers and normals
+    falg::float3 meshCenter{0, 0, 0};
+    float meshArea = 0;
+    std::vector<falg::float3> centers(clusterCount);
+    std::vector<falg::float3> normals(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        falg::float3 center{0, 0, 0};
+        falg::float3 normal{0, 0, 0};
+        float area = 0;
+        for (auto t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            auto &p0 = positions[indices[t * 3]];
+            auto &p1 = positions[indices[t * 3 + 1]];
+            auto &p2 = positions[indices[t * 3 + 2]];
+            auto n = detail::front_normal(p0, p1, p2, frontFace);
+            auto a = falg::Length(n);
+            center += (p0 + p1 + p2) * (a / 3);
+            normal += n;
+            area += a;
+        }
+        meshCenter += center;
+        meshArea += area;
+        centers[c] = area > 0 ? center * (1 / area) : positions[indices[clusters[c] * 3]];
+        normals[c] = normal;
+    }
+    if (meshArea > 0)
+    {
+        meshCenter = meshCenter * (1 / meshArea);
+    }
+
+    std::vector<float> keys(clusterCount);
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        auto n = normals[c];
+        auto l = falg::Length(n);
+        keys[c] = l > 0 ? falg::Dot(centers[c] - meshCenter, n * (1 / l)) : 0;
+        order[c] = static_cast<uint32_t>(c);
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](uint32_t l, uint32_t r) { return keys[l] > keys[r]; });
+
+    std::vector<T> input(indices.begin(), indices.begin() + triangleCount * 3);
+    size_t written = 0;
+    for (auto c : order)
+    {
+        for (auto i = clusters[c] * 3; i < clusters[c + 1] * 3; ++i)
+        {
+            indices[written++] = input[i];
+        }
+    }
+    return clusterCount;
+}
+
+// the position is the float3 at positionOffset in each vertex. 16 or 32 bit indices of the mesh in place
+inline OverdrawResult OptimizeOverdraw(MeshBuilder &mesh, uint32_t positionOffset = 0, FrontFace frontFace = FrontFace::Clockwise,
+                                       float threshold = 1.05f, uint32_t cacheSize = 16)
+{
+    auto positions = detail::positions(mesh, positionOffset);
+    OverdrawResult result;
+    detail::with_indices(mesh, [&](auto indices) {
+        using T = typename decltype(indices)::value_type;
+        result.before = AnalyzeOverdraw<T>(indices, positions, frontFace);
+        result.clusters = OptimizeOverdraw(indices, std::span<const falg::float3>(positions), frontFace, threshold, cacheSize);
+        result.after = AnalyzeOverdraw<T>(indices, positions, frontFace);
+    });
+    return result;
+}
+
+// remap of a vertex that no index refers to
+const uint32_t UNUSED_VERTEX = UINT32_MAX;
+
+struct VertexFetchResult
+{
+    size_t vertexCountBefore = 0;
+    size_t vertexCountAfter = 0;
+    // of the dropped vertices
+    size_t bytesSaved = 0;
+};
+
+///
+/// number the vertices in the order of the first use and rewrite indices.
+/// remap[old] is the new index, UNUSED_VERTEX for the vertices not referenced.
+/// returns the used vertex count. run after OptimizeVertexCache and OptimizeOverdraw, they change the order of use.
+/// throws before any change if an index is out of remap
+///
+template <typename T>
+size_t OptimizeVertexFetchRemap(std::span<T> indices, std::span<uint32_t> remap)
+{
+    if (remap.size() >= UNUSED_VERTEX)
+    {
+        throw std::runtime_error("too many vertices");
+    }
+    for (auto i : indices)
+    {
+        if (i >= remap.size())
+        {
+            throw std::runtime_error("index out of range");
+        }
+    }
+
+    std::fill(remap.begin(), remap.end(), UNUSED_VERTEX);
+    uint32_t next = 0;
+    for (auto &i : indices)
+    {
+        auto &r = remap[i];
+        if (r == UNUSED_VERTEX)
+        {
+            r = next++;
+        }
+        i = static_cast<T>(r);
+    }
+    return next;
+}
+
+///
+/// reorder VerticesData in the first use order of IndicesData and drop the unreferenced vertices.
+/// vertices are moved as VertexStride bytes, any vertex format.
+///
+/// OptimizeVertexCache(mesh);
+/// OptimizeOverdraw(mesh);
+/// auto result = OptimizeVertexFetch(mesh);
+///
+inline VertexFetchResult OptimizeVertexFetch(MeshBuilder &mesh)
+{
+    auto vertexCount = detail::vertex_count(mesh);
+    std::vector<uint32_t> remap(vertexCount);
+    size_t used = 0;
+    detail::with_indices(mesh, [&](auto indices) {
+        used = OptimizeVertexFetchRemap(indices, std::span<uint32_t>(remap));
+    });
+
+    auto stride = mesh.VertexStride;
+    std::vector<uint8_t> vertices(used * stride);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] != UNUSED_VERTEX)
+        {
+            memcpy(vertices.data() + remap[i] * stride, mesh.VerticesData.data() + i * stride, stride);
+        }
+    }
+    mesh.VerticesData.swap(vertices);
+    return {vertexCount, used, (vertexCount - used) * stride};
+}
+
+} // namespace wgut::mesh
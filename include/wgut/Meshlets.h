@@ -0,0 +1,401 @@
+#pragma once
+#include "CameraState.h"
+#include "MeshOptimizer.h"
+#include <falg.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::mesh
+{
+
+struct Meshlet
+{
+    // range of Meshlets::Vertices. unique vertex indices of the meshlet
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    // range of Meshlets::Indices. 3 per triangle
+    uint32_t indexOffset;
+    uint32_t triangleCount;
+
+    falg::Sphere bounds;
+    // the front side normals of the triangles are within the cone around axis.
+    // back facing from the camera c if dot(center - c, axis) > cutoff * |center - c| + radius.
+    // cutoff is sin of the cone angle, 1 for the cone wider than a half sphere that is never culled
+    falg::float3 coneAxis;
+    float coneCutoff;
+};
+
+///
+/// a mesh split into small clusters of triangles, meshlets, for culling finer than objects.
+///
+/// Meshlets meshlets;
+/// meshlets.Build(indices, positions, FrontFace::Clockwise, 64, 124); // at most 64 vertices and 124 triangles
+/// // every frame
+/// auto count = meshlets.Cull(camera, visibleIndices, world);
+/// context->DrawIndexed(count, 0, 0); // visibleIndices uploaded to the index buffer
+///
+/// triangles are grown from a seed to the neighbors sharing the most vertices, then the most similar normal.
+/// run OptimizeVertexCache first, the seeds are taken in the index order.
+/// the vertex buffer is not changed, Indices refer to it.
+///
+class Meshlets
+{
+    std::vector<Meshlet> m_meshlets;
+    std::vector<uint32_t> m_vertices;
+    std::vector<uint32_t> m_indices;
+    // of the built mesh. Cull checks the index type
+    size_t m_vertexCount = 0;
+
+    static const uint32_t NONE = UINT32_MAX;
+
+    // normals of the triangles
+    void Flush(std::span<const falg::float3> positions, std::span<const uint32_t> vertices,
+               std::span<const uint32_t> triangles, std::span<const falg::float3> normals)
+    {
+        Meshlet meshlet{
+            static_cast<uint32_t>(m_vertices.size()),
+            static_cast<uint32_t>(vertices.size()),
+            static_cast<uint32_t>(m_indices.size()),
+            static_cast<uint32_t>(triangles.size() / 3),
+            {},
+            {0, 0, 1},
+            1,
+        };
+        m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+        m_indices.insert(m_indices.end(), triangles.begin(), triangles.end());
+
+        // the center of the box and the farthest vertex
+        falg::AABB aabb;
+        for (auto v : vertices)
+        {
+            aabb.Expand(positions[v]);
+        }
+        meshlet.bounds.center = aabb.Center();
+        meshlet.bounds.radius = 0;
+        for (auto v : vertices)
+        {
+            meshlet.bounds.radius = std::max(meshlet.bounds.radius, falg::Length(positions[v] - meshlet.bounds.center));
+        }
+
+        // the mean of the unit normals. degenerated triangles have zero normals and are ignored
+        falg::float3 axis{0, 0, 0};
+        for (auto &n : normals)
+        {
+            axis += n;
+        }
+        auto length = falg::Length(axis);
+        if (length > 0)
+        {
+            meshlet.coneAxis = axis * (1 / length);
+            auto minDot = 1.0f;
+            for (auto &n : normals)
+            {
+                if (falg::Dot(n, n) > 0)
+                {
+                    minDot = std::min(minDot, falg::Dot(n, meshlet.coneAxis));
+                }
+            }
+            if (minDot > 0)
+            {
+                meshlet.coneCutoff = std::sqrt(std::max(1 - minDot * minDot, 0.0f));
+            }
+        }
+        m_meshlets.push_back(meshlet);
+    }
+
+    // frustum and the camera position in the local space of the mesh
+    template <typename F>
+    void Test(const CameraState &camera, const std::array<float, 16> &world, PerspectiveTypes type, const F &f) const
+    {
+        auto frustum = falg::Frustum::FromRowMatrix(falg::RowMatrixMul(world, falg::RowMatrixMul(camera.view, camera.projection)),
+                                                    type == PerspectiveTypes::OpenGL ? falg::ClipDepth::MinusOneToOne : falg::ClipDepth::ZeroToOne);
+        std::array<float, 16> inverse;
+        if (!falg::RowMatrixInverse(world, &inverse))
+        {
+            throw std::runtime_error("world is not invertible");
+        }
+        // the sign of the back face test is kept by an affine transform, the cone is tested in the local space
+        auto eye = falg::RowMatrixApplyPosition(inverse, camera.position);
+        for (uint32_t i = 0; i < m_meshlets.size(); ++i)
+        {
+            auto &meshlet = m_meshlets[i];
+            auto d = meshlet.bounds.center - eye;
+            if (falg::Dot(d, meshlet.coneAxis) > meshlet.coneCutoff * falg::Length(d) + meshlet.bounds.radius)
+            {
+                continue;
+            }
+            if (!frustum.ContainsSphere(meshlet.bounds.center, meshlet.bounds.radius))
+            {
+                continue;
+            }
+            if (!f(i))
+            {
+                return;
+            }
+        }
+    }
+
+public:
+    std::span<const Meshlet> Items() const
+    {
+        return m_meshlets;
+    }
+
+    size_t Size() const
+    {
+        return m_meshlets.size();
+    }
+
+    // vertex indices of the meshlets. Meshlet::vertexOffset is the start
+    std::span<const uint32_t> Vertices() const
+    {
+        return m_vertices;
+    }
+
+    // triangles in the meshlet order. Meshlet::indexOffset is the start. the index buffer to draw all
+    std::span<const uint32_t> Indices() const
+    {
+        return m_indices;
+    }
+
+    template <typename T>
+    void Build(std::span<const T> indices, std::span<const falg::float3> positions, FrontFace frontFace,
+               uint32_t maxVertices = 64, uint32_t maxTriangles = 124)
+    {
+        if (maxVertices < 3 || maxTriangles < 1)
+        {
+            throw std::runtime_error("invalid meshlet size");
+        }
+        m_meshlets.clear();
+        m_vertices.clear();
+        m_indices.clear();
+        m_vertexCount = positions.size();
+        auto triangleCount = indices.size() / 3;
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            if (indices[i] >= positions.size())
+            {
+                throw std::runtime_error("index out of range");
+            }
+        }
+
+        std::vector<falg::float3> normals(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            auto n = detail::front_normal(positions[indices[t * 3]], positions[indices[t * 3 + 1]], positions[indices[t * 3 + 2]], frontFace);
+            auto length = falg::Length(n);
+            normals[t] = length > 0 ? n * (1 / length) : falg::float3{0, 0, 0};
+        }
+
+        // triangles of each vertex
+        std::vector<uint32_t> offsets(positions.size() + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            ++offsets[indices[i] + 1];
+        }
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            auto cursor = offsets;
+            for (size_t i = 0; i < triangleCount * 3; ++i)
+            {
+                adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::vector<uint8_t> used(triangleCount, 0);
+        // the meshlet that has the vertex
+        std::vector<uint32_t> owner(positions.size(), NONE);
+        auto current = 0u;
+        std::vector<uint32_t> vertices;
+        std::vector<uint32_t> triangles;
+        std::vector<falg::float3> triangleNormals;
+        // triangles next to the meshlet, used ones are removed lazily
+        std::vector<uint32_t> candidates;
+        // the meshlet that has the triangle in candidates
+        std::vector<uint32_t> listed(triangleCount, NONE);
+        falg::float3 normalSum{0, 0, 0};
+
+        auto newVertices = [&](size_t t) {
+            uint32_t count = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                if (owner[indices[t * 3 + k]] != current)
+                {
+                    ++count;
+                }
+            }
+            return count;
+        };
+        auto flush = [&]() {
+            Flush(positions, vertices, triangles, triangleNormals);
+            vertices.clear();
+            triangles.clear();
+            triangleNormals.clear();
+            candidates.clear();
+            normalSum = {0, 0, 0};
+            ++current;
+        };
+        auto add = [&](size_t t) {
+            used[t] = 1;
+            for (int k = 0; k < 3; ++k)
+            {
+                auto v = indices[t * 3 + k];
+                triangles.push_back(static_cast<uint32_t>(v));
+                if (owner[v] != current)
+                {
+                    owner[v] = current;
+                    vertices.push_back(static_cast<uint32_t>(v));
+                    for (auto i = offsets[v]; i < offsets[v + 1]; ++i)
+                    {
+                        auto c = adjacency[i];
+                        if (!used[c] && listed[c] != current)
+                        {
+                            listed[c] = current;
+                            candidates.push_back(c);
+                        }
+                    }
+                }
+            }
+            normalSum += normals[t];
+            triangleNormals.push_back(normals[t]);
+        };
+
+        size_t seed = 0;
+        while (true)
+        {
+            if (triangles.empty())
+            {
+                while (seed < triangleCount && used[seed])
+                {
+                    ++seed;
+                }
+                if (seed == triangleCount)
+                {
+                    break;
+                }
+                add(seed);
+            }
+            else
+            {
+                // fewest new vertices, then the normal closest to the meshlet
+                auto best = NONE;
+                auto bestScore = std::numeric_limits<float>::infinity();
+                auto mean = normalSum * (1 / std::max(falg::Length(normalSum), 1e-6f));
+                size_t kept = 0;
+                for (auto t : candidates)
+                {
+                    if (used[t])
+                    {
+                        continue;
+                    }
+                    candidates[kept++] = t;
+                    auto count = newVertices(t);
+                    if (vertices.size() + count > maxVertices)
+                    {
+                        continue;
+                    }
+                    auto score = count + (1 - falg::Dot(normals[t], mean)) * 0.25f;
+                    if (score < bestScore)
+                    {
+                        best = t;
+                        bestScore = score;
+                    }
+                }
+                candidates.resize(kept);
+                if (best == NONE)
+                {
+                    flush();
+                    continue;
+                }
+                add(best);
+            }
+            if (triangles.size() / 3 == maxTriangles)
+            {
+                flush();
+            }
+        }
+        if (!triangles.empty())
+        {
+            flush();
+        }
+    }
+
+    template <typename V>
+    void Build(std::span<const V> vertices, falg::float3 V::*position, std::span<const uint32_t> indices, FrontFace frontFace,
+               uint32_t maxVertices = 64, uint32_t maxTriangles = 124)
+    {
+        std::vector<falg::float3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            positions[i] = vertices[i].*position;
+        }
+        Build(indices, std::span<const falg::float3>(positions), frontFace, maxVertices, maxTriangles);
+    }
+
+    // the position is the float3 at positionOffset in each vertex
+    void Build(MeshBuilder &mesh, uint32_t positionOffset = 0, FrontFace frontFace = FrontFace::Clockwise,
+               uint32_t maxVertices = 64, uint32_t maxTriangles = 124)
+    {
+        auto positions = detail::positions(mesh, positionOffset);
+        detail::with_indices(mesh, [&](auto indices) {
+            using T = typename decltype(indices)::value_type;
+            Build(std::span<const T>(indices), std::span<const falg::float3>(positions), frontFace, maxVertices, maxTriangles);
+        });
+    }
+
+    // meshlets in the frustum and not back facing. returns the count written to dst, stops when dst is full
+    size_t Visible(const CameraState &camera, std::span<uint32_t> dst, const std::array<float, 16> &world = falg::IdentityMatrix(),
+                   PerspectiveTypes type = PerspectiveTypes::D3D) const
+    {
+        size_t count = 0;
+        Test(camera, world, type, [&](uint32_t i) {
+            if (count == dst.size())
+            {
+                return false;
+            }
+            dst[count++] = i;
+            return true;
+        });
+        return count;
+    }
+
+    ///
+    /// the triangles of the visible meshlets, for a single DrawIndexed. returns the index count.
+    /// dst must hold Indices().size() and T must hold the vertex indices
+    ///
+    template <typename T>
+    size_t Cull(const CameraState &camera, std::span<T> dst, const std::array<float, 16> &world = falg::IdentityMatrix(),
+                PerspectiveTypes type = PerspectiveTypes::D3D) const
+    {
+        if (dst.size() < m_indices.size())
+        {
+            throw std::runtime_error("buffer too small");
+        }
+        if (m_vertexCount > 0 && m_vertexCount - 1 > std::numeric_limits<T>::max())
+        {
+            throw std::runtime_error("index type too small");
+        }
+        size_t count = 0;
+        Test(camera, world, type, [&](uint32_t i) {
+            auto &meshlet = m_meshlets[i];
+            auto src = m_indices.data() + meshlet.indexOffset;
+            for (uint32_t j = 0; j < meshlet.triangleCount * 3; ++j)
+            {
+                dst[count++] = static_cast<T>(src[j]);
+            }
+            return true;
+        });
+        return count;
+    }
+};
+
+} // namespace wgut::mesh
@@ -0,0 +1,578 @@
+#pragma once
+#include "CameraState.h"
+#include "MeshBuilder.h"
+#include "TransformStore.h"
+#include <falg.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <span>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+
+namespace wgut::scene
+{
+
+///
+/// software occlusion culling. large occluders are rasterized on the cpu into a small depth buffer
+/// and the boxes of the objects are tested against it. no gpu, no readback.
+///
+/// OcclusionCuller culler(256, 128);
+/// culler.Begin(camera.state, camera.perspectiveType);
+/// culler.AddOccluder(vertices, indices, &Vertex::position, world); // walls, floors, large props
+/// culler.Rasterize(); // tiles in threads
+/// if (culler.IsVisible(aabb)) { draw }
+/// auto count = culler.Visible(boxes, visible); // or a batch of boxes
+///
+/// depth is z / w in [0, 1], 0 is near. every 8x8 block keeps its farthest depth (hierarchical z),
+/// a box nearer than the block is visible without reading the pixels.
+///
+/// a pixel is covered if the triangle contains the center like the gpu, a gap thinner than a pixel
+/// between occluders may be closed. the depth is conservative, a pixel keeps the farthest depth of the triangle
+/// inside the pixel. triangles crossing the near plane are clipped and boxes crossing it are visible.
+///
+class OcclusionCuller
+{
+public:
+    static const uint32_t BLOCK_SIZE = 8;
+    // multiples of BLOCK_SIZE
+    static const uint32_t TILE_WIDTH = 64;
+    static const uint32_t TILE_HEIGHT = 32;
+
+private:
+    struct ScreenTriangle
+    {
+        // edge functions a * x + b * y + c. inside if all three >= 0
+        std::array<float, 3> a;
+        std::array<float, 3> b;
+        std::array<float, 3> c;
+        // depth plane with the bias of a half pixel
+        float za;
+        float zb;
+        float zc;
+        float zmax;
+        // pixel rect. max is exclusive
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+    // 64 byte aligned rows of multiples of 8
+    AlignedVector<float> m_depth;
+    // farthest depth of each block
+    std::vector<float> m_blocks;
+
+    std::array<float, 16> m_viewProjection = falg::IdentityMatrix();
+    bool m_minusOneToOne = false;
+
+    std::vector<ScreenTriangle> m_triangles;
+    // triangle indices of each tile
+    std::vector<std::vector<uint32_t>> m_bins;
+    // work buffer
+    std::vector<falg::float4> m_clip;
+
+    falg::float4 ToClip(const std::array<float, 16> &m, const falg::float3 &p) const
+    {
+        return {
+            p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12],
+            p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13],
+            p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14],
+            p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + m[15],
+        };
+    }
+
+    // signed distance to the near plane in the clip space. in front if >= 0
+    float NearDistance(const falg::float4 &v) const
+    {
+        return m_minusOneToOne ? v[2] + v[3] : v[2];
+    }
+
+    // in front of the near plane
+    bool InFront(const falg::float4 &v) const
+    {
+        return v[3] > 0 && NearDistance(v) >= 0;
+    }
+
+    // pixel x, pixel y, depth in [0, 1]
+    falg::float3 ToScreen(const falg::float4 &v) const
+    {
+        auto w = 1 / v[3];
+        auto z = v[2] * w;
+        return {
+            (v[0] * w * 0.5f + 0.5f) * m_width,
+            (0.5f - v[1] * w * 0.5f) * m_height,
+            m_minusOneToOne ? z * 0.5f + 0.5f : z,
+        };
+    }
+
+    // clip at the near plane. the winding is kept
+    void AddTriangle(const falg::float4 &c0, const falg::float4 &c1, const falg::float4 &c2, bool cullBackfaces)
+    {
+        std::array<const falg::float4 *, 3> v{&c0, &c1, &c2};
+        std::array<float, 3> d{NearDistance(c0), NearDistance(c1), NearDistance(c2)};
+        if (d[0] >= 0 && d[1] >= 0 && d[2] >= 0)
+        {
+            AddClippedTriangle(c0, c1, c2, cullBackfaces);
+            return;
+        }
+
+        // a triangle becomes a triangle or a quad
+        std::array<falg::float4, 4> polygon;
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto j = (i + 1) % 3;
+            if (d[i] >= 0)
+            {
+                polygon[count++] = *v[i];
+            }
+            if ((d[i] >= 0) != (d[j] >= 0))
+            {
+                auto t = d[i] / (d[i] - d[j]);
+                auto &a = *v[i];
+                auto &b = *v[j];
+                polygon[count++] = {
+                    a[0] + (b[0] - a[0]) * t,
+                    a[1] + (b[1] - a[1]) * t,
+                    a[2] + (b[2] - a[2]) * t,
+                    a[3] + (b[3] - a[3]) * t,
+                };
+            }
+        }
+        for (int i = 2; i < count; ++i)
+        {
+            AddClippedTriangle(polygon[0], polygon[i - 1], polygon[i], cullBackfaces);
+        }
+    }
+
+    // in front of the near plane
+    void AddClippedTriangle(const falg::float4 &c0, const falg::float4 &c1, const falg::float4 &c2, bool cullBackfaces)
+    {
+        if (!(c0[3] > 0 && c1[3] > 0 && c2[3] > 0))
+        {
+            return;
+        }
+        // outside of a side or the far plane
+        for (int i = 0; i < 3; ++i)
+        {
+            if ((c0[i] > c0[3] && c1[i] > c1[3] && c2[i] > c2[3]) || (i < 2 && c0[i] < -c0[3] && c1[i] < -c1[3] && c2[i] < -c2[3]))
+            {
+                return;
+            }
+        }
+
+        std::array<falg::float3, 3> p{ToScreen(c0), ToScreen(c1), ToScreen(c2)};
+        // clockwise on the screen is positive. the front face of the d3d11 default rasterizer state
+        auto area = (p[1][0] - p[0][0]) * (p[2][1] - p[0][1]) - (p[2][0] - p[0][0]) * (p[1][1] - p[0][1]);
+        if (area == 0 || (area < 0 && cullBackfaces))
+        {
+            return;
+        }
+        if (area < 0)
+        {
+            std::swap(p[1], p[2]);
+            area = -area;
+        }
+
+        auto x0 = std::max(0, static_cast<int>(std::floor(std::min(std::min(p[0][0], p[1][0]), p[2][0]))));
+        auto y0 = std::max(0, static_cast<int>(std::floor(std::min(std::min(p[0][1], p[1][1]), p[2][1]))));
+        auto x1 = std::min(static_cast<int>(m_width), static_cast<int>(std::ceil(std::max(std::max(p[0][0], p[1][0]), p[2][0]))));
+        auto y1 = std::min(static_cast<int>(m_height), static_cast<int>(std::ceil(std::max(std::max(p[0][1], p[1][1]), p[2][1]))));
+        if (x0 >= x1 || y0 >= y1)
+        {
+            return;
+        }
+
+        ScreenTriangle t;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto &s = p[i];
+            auto &e = p[(i + 1) % 3];
+            t.a[i] = s[1] - e[1];
+            t.b[i] = e[0] - s[0];
+            t.c[i] = (e[1] - s[1]) * s[0] - (e[0] - s[0]) * s[1];
+            if (InnerCoverage)
+            {
+                // the farthest pixel corner from the edge is inside
+                t.c[i] -= 0.5f * (std::abs(t.a[i]) + std::abs(t.b[i]));
+            }
+        }
+        auto dz1 = p[1][2] - p[0][2];
+        auto dz2 = p[2][2] - p[0][2];
+        t.za = (dz1 * (p[2][1] - p[0][1]) - dz2 * (p[1][1] - p[0][1])) / area;
+        t.zb = (dz2 * (p[1][0] - p[0][0]) - dz1 * (p[2][0] - p[0][0])) / area;
+        // the farthest depth in the pixel around the sample
+        t.zc = p[0][2] - t.za * p[0][0] - t.zb * p[0][1] + 0.5f * (std::abs(t.za) + std::abs(t.zb));
+        t.zmax = std::max(std::max(p[0][2], p[1][2]), p[2][2]);
+        t.x0 = x0;
+        t.y0 = y0;
+        t.x1 = x1;
+        t.y1 = y1;
+
+        auto index = static_cast<uint32_t>(m_triangles.size());
+        m_triangles.push_back(t);
+        for (auto ty = y0 / TILE_HEIGHT; ty <= (y1 - 1) / TILE_HEIGHT; ++ty)
+        {
+            for (auto tx = x0 / TILE_WIDTH; tx <= (x1 - 1) / TILE_WIDTH; ++tx)
+            {
+                m_bins[ty * m_tilesX + tx].push_back(index);
+            }
+        }
+    }
+
+    template <typename F>
+    void AddTriangles(size_t indexCount, const F &index, bool cullBackfaces)
+    {
+        indexCount -= indexCount % 3;
+        // before any triangle is added
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            if (index(i) >= m_clip.size())
+            {
+                throw std::runtime_error("index out of range");
+            }
+        }
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            AddTriangle(m_clip[index(i)], m_clip[index(i + 1)], m_clip[index(i + 2)], cullBackfaces);
+        }
+    }
+
+    void RasterizeTriangle(const ScreenTriangle &t, int tx0, int ty0, int tx1, int ty1)
+    {
+        // 4 aligned pixels per step. tiles are multiples of 4
+        auto x0 = std::max(t.x0, tx0) & ~3;
+        auto x1 = std::min(t.x1, tx1);
+        auto y0 = std::max(t.y0, ty0);
+        auto y1 = std::min(t.y1, ty1);
+#if defined(FALG_SSE2)
+        auto a0 = _mm_set1_ps(t.a[0]);
+        auto a1 = _mm_set1_ps(t.a[1]);
+        auto a2 = _mm_set1_ps(t.a[2]);
+        auto za = _mm_set1_ps(t.za);
+        auto zmax = _mm_set1_ps(t.zmax);
+        auto empty = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        auto zero = _mm_setzero_ps();
+        auto offset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        // the edge functions step by 4 * a
+        auto step0 = _mm_set1_ps(t.a[0] * 4);
+        auto step1 = _mm_set1_ps(t.a[1] * 4);
+        auto step2 = _mm_set1_ps(t.a[2] * 4);
+        auto stepz = _mm_set1_ps(t.za * 4);
+        auto px0 = _mm_add_ps(_mm_set1_ps(static_cast<float>(x0)), offset);
+        for (auto y = y0; y < y1; ++y)
+        {
+            auto py = y + 0.5f;
+            auto e0 = _mm_add_ps(_mm_mul_ps(a0, px0), _mm_set1_ps(t.b[0] * py + t.c[0]));
+            auto e1 = _mm_add_ps(_mm_mul_ps(a1, px0), _mm_set1_ps(t.b[1] * py + t.c[1]));
+            auto e2 = _mm_add_ps(_mm_mul_ps(a2, px0), _mm_set1_ps(t.b[2] * py + t.c[2]));
+            auto z = _mm_add_ps(_mm_mul_ps(za, px0), _mm_set1_ps(t.zb * py + t.zc));
+            auto row = m_depth.data() + y * m_width;
+            for (auto x = x0; x < x1; x += 4)
+            {
+                auto inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside))
+                {
+                    auto d = _mm_min_ps(z, zmax);
+                    d = _mm_or_ps(_mm_and_ps(inside, d), _mm_andnot_ps(inside, empty));
+                    _mm_store_ps(row + x, _mm_min_ps(_mm_load_ps(row + x), d));
+                }
+                e0 = _mm_add_ps(e0, step0);
+                e1 = _mm_add_ps(e1, step1);
+                e2 = _mm_add_ps(e2, step2);
+                z = _mm_add_ps(z, stepz);
+            }
+        }
+#else
+        for (auto y = y0; y < y1; ++y)
+        {
+            auto py = y + 0.5f;
+            auto row = m_depth.data() + y * m_width;
+            for (auto x = x0; x < x1; ++x)
+            {
+                auto px = x + 0.5f;
+                if (t.a[0] * px + (t.b[0] * py + t.c[0]) >= 0 && t.a[1] * px + (t.b[1] * py + t.c[1]) >= 0 && t.a[2] * px + (t.b[2] * py + t.c[2]) >= 0)
+                {
+                    row[x] = std::min(row[x], std::min(t.za * px + (t.zb * py + t.zc), t.zmax));
+                }
+            }
+        }
+#endif
+    }
+
+    void RasterizeTile(uint32_t tile)
+    {
+        auto tx0 = static_cast<int>(tile % m_tilesX * TILE_WIDTH);
+        auto ty0 = static_cast<int>(tile / m_tilesX * TILE_HEIGHT);
+        auto tx1 = std::min(tx0 + static_cast<int>(TILE_WIDTH), static_cast<int>(m_width));
+        auto ty1 = std::min(ty0 + static_cast<int>(TILE_HEIGHT), static_cast<int>(m_height));
+        for (auto i : m_bins[tile])
+        {
+            RasterizeTriangle(m_triangles[i], tx0, ty0, tx1, ty1);
+        }
+
+        // hierarchical z
+        auto blocksX = m_width / BLOCK_SIZE;
+        for (auto by = ty0; by < ty1; by += BLOCK_SIZE)
+        {
+            for (auto bx = tx0; bx < tx1; bx += BLOCK_SIZE)
+            {
+#if defined(FALG_SSE2)
+                auto z4 = _mm_setzero_ps();
+                for (auto y = by; y < by + static_cast<int>(BLOCK_SIZE); ++y)
+                {
+                    auto row = m_depth.data() + y * m_width + bx;
+                    z4 = _mm_max_ps(z4, _mm_max_ps(_mm_load_ps(row), _mm_load_ps(row + 4)));
+                }
+                z4 = _mm_max_ps(z4, _mm_shuffle_ps(z4, z4, _MM_SHUFFLE(1, 0, 3, 2)));
+                z4 = _mm_max_ps(z4, _mm_shuffle_ps(z4, z4, _MM_SHUFFLE(2, 3, 0, 1)));
+                auto z = _mm_cvtss_f32(z4);
+#else
+                float z = 0;
+                for (auto y = by; y < by + static_cast<int>(BLOCK_SIZE); ++y)
+                {
+                    auto row = m_depth.data() + y * m_width;
+                    for (auto x = bx; x < bx + static_cast<int>(BLOCK_SIZE); ++x)
+                    {
+                        z = std::max(z, row[x]);
+                    }
+                }
+#endif
+                m_blocks[by / BLOCK_SIZE * blocksX + bx / BLOCK_SIZE] = z;
+            }
+        }
+    }
+
+public:
+    // cover the pixels inside the triangle only. never hides a visible box,
+    // but the shared edges of the occluder triangles leave holes
+    bool InnerCoverage = false;
+
+    // the size is rounded up to BLOCK_SIZE
+    OcclusionCuller(uint32_t width = 256, uint32_t height = 128)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw std::runtime_error("invalid size");
+        }
+        m_width = (width + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+        m_height = (height + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+        m_tilesX = (m_width + TILE_WIDTH - 1) / TILE_WIDTH;
+        m_tilesY = (m_height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        m_depth.resize(m_width * m_height, 1.0f);
+        m_blocks.resize(m_width / BLOCK_SIZE * (m_height / BLOCK_SIZE), 1.0f);
+        m_bins.resize(m_tilesX * m_tilesY);
+    }
+
+    uint32_t Width() const
+    {
+        return m_width;
+    }
+
+    uint32_t Height() const
+    {
+        return m_height;
+    }
+
+    // row major. valid after Rasterize
+    std::span<const float> Depth() const
+    {
+        return m_depth;
+    }
+
+    // triangles drawn by the last Rasterize
+    size_t TriangleCount() const
+    {
+        return m_triangles.size();
+    }
+
+    // clear the occluders and set the camera of this frame
+    void Begin(const CameraState &camera, PerspectiveTypes type = PerspectiveTypes::D3D)
+    {
+        m_viewProjection = falg::RowMatrixMul(camera.view, camera.projection);
+        m_minusOneToOne = type == PerspectiveTypes::OpenGL;
+        m_triangles.clear();
+        for (auto &bin : m_bins)
+        {
+            bin.clear();
+        }
+    }
+
+    ///
+    /// occluder triangles. the world matrix is applied to the positions.
+    /// cullBackfaces skips the counter clockwise triangles on the screen, for the meshes drawn with back face culling
+    ///
+    template <typename V>
+    void AddOccluder(std::span<const V> vertices, std::span<const uint32_t> indices, falg::float3 V::*position,
+                     const std::array<float, 16> &world = falg::IdentityMatrix(), bool cullBackfaces = false)
+    {
+        auto m = falg::RowMatrixMul(world, m_viewProjection);
+        m_clip.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            m_clip[i] = ToClip(m, vertices[i].*position);
+        }
+        AddTriangles(
+            indices.size(), [indices](size_t i) { return indices[i]; }, cullBackfaces);
+    }
+
+    // the position is the float3 at positionOffset in each vertex. 16 or 32 bit indices
+    void AddOccluder(const mesh::MeshBuilder &mesh, uint32_t positionOffset = 0,
+                     const std::array<float, 16> &world = falg::IdentityMatrix(), bool cullBackfaces = false)
+    {
+        if (mesh.VertexStride < positionOffset + sizeof(falg::float3))
+        {
+            throw std::runtime_error("invalid position offset");
+        }
+        auto m = falg::RowMatrixMul(world, m_viewProjection);
+        auto vertexCount = mesh.VerticesData.size() / mesh.VertexStride;
+        m_clip.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            falg::float3 p;
+            memcpy(&p, mesh.VerticesData.data() + i * mesh.VertexStride + positionOffset, sizeof(p));
+            m_clip[i] = ToClip(m, p);
+        }
+
+        auto data = mesh.IndicesData.data();
+        switch (mesh.IndexStride)
+        {
+        case 2:
+            AddTriangles(
+                mesh.IndicesData.size() / 2, [data](size_t i) { uint16_t index; memcpy(&index, data + i * 2, 2); return index; }, cullBackfaces);
+            break;
+
+        case 4:
+            AddTriangles(
+                mesh.IndicesData.size() / 4, [data](size_t i) { uint32_t index; memcpy(&index, data + i * 4, 4); return index; }, cullBackfaces);
+            break;
+
+        default:
+            throw std::runtime_error("not implemented");
+        }
+    }
+
+    // draw the occluders. each thread takes the next tile
+    void Rasterize(uint32_t threadCount = std::thread::hardware_concurrency())
+    {
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+        auto tileCount = m_tilesX * m_tilesY;
+        std::atomic<uint32_t> next = 0;
+        auto worker = [this, tileCount, &next]() {
+            for (auto tile = next++; tile < tileCount; tile = next++)
+            {
+                RasterizeTile(tile);
+            }
+        };
+
+        threadCount = std::min(std::max(threadCount, 1u), tileCount);
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    // false if the box is behind the occluders or out of the view. valid after Rasterize
+    bool IsVisible(const falg::AABB &aabb) const
+    {
+        if (aabb.IsEmpty())
+        {
+            return false;
+        }
+        float minX = std::numeric_limits<float>::infinity();
+        float minY = minX;
+        float minZ = minX;
+        float maxX = -minX;
+        float maxY = -minX;
+        for (int i = 0; i < 8; ++i)
+        {
+            auto c = ToClip(m_viewProjection, {
+                                                  i & 1 ? aabb.max[0] : aabb.min[0],
+                                                  i & 2 ? aabb.max[1] : aabb.min[1],
+                                                  i & 4 ? aabb.max[2] : aabb.min[2],
+                                              });
+            if (!InFront(c))
+            {
+                // the camera may be inside
+                return true;
+            }
+            auto s = ToScreen(c);
+            minX = std::min(minX, s[0]);
+            minY = std::min(minY, s[1]);
+            minZ = std::min(minZ, s[2]);
+            maxX = std::max(maxX, s[0]);
+            maxY = std::max(maxY, s[1]);
+        }
+        if (maxX <= 0 || maxY <= 0 || minX >= m_width || minY >= m_height || minZ > 1)
+        {
+            return false;
+        }
+
+        auto x0 = std::max(0, static_cast<int>(std::floor(minX)));
+        auto y0 = std::max(0, static_cast<int>(std::floor(minY)));
+        auto x1 = std::min(static_cast<int>(m_width), static_cast<int>(std::ceil(maxX)));
+        auto y1 = std::min(static_cast<int>(m_height), static_cast<int>(std::ceil(maxY)));
+        auto blocksX = m_width / BLOCK_SIZE;
+        for (auto by = y0 / static_cast<int>(BLOCK_SIZE); by <= (y1 - 1) / static_cast<int>(BLOCK_SIZE); ++by)
+        {
+            for (auto bx = x0 / static_cast<int>(BLOCK_SIZE); bx <= (x1 - 1) / static_cast<int>(BLOCK_SIZE); ++bx)
+            {
+                if (m_blocks[by * blocksX + bx] < minZ)
+                {
+                    // the whole block is nearer
+                    continue;
+                }
+                auto px0 = std::max(x0, bx * static_cast<int>(BLOCK_SIZE));
+                auto py0 = std::max(y0, by * static_cast<int>(BLOCK_SIZE));
+                auto px1 = std::min(x1, (bx + 1) * static_cast<int>(BLOCK_SIZE));
+                auto py1 = std::min(y1, (by + 1) * static_cast<int>(BLOCK_SIZE));
+                for (auto y = py0; y < py1; ++y)
+                {
+                    auto row = m_depth.data() + y * m_width;
+                    for (auto x = px0; x < px1; ++x)
+                    {
+                        if (row[x] >= minZ)
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // indices of the visible boxes. returns the count written to visible
+    size_t Visible(const falg::aabb_span &boxes, std::span<uint32_t> visible) const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < boxes.size() && count < visible.size(); ++i)
+        {
+            falg::AABB aabb{
+                {boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]},
+                {boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]},
+            };
+            if (IsVisible(aabb))
+            {
+                visible[count++] = static_cast<uint32_t>(i);
+            }
+        }
+        return count;
+    }
+};
+
+} // namespace wgut::scene
@@ -0,0 +1,231 @@
+#pragma once
+#include "Bvh.h"
+#include "MeshBvh.h"
+#include <falg.h>
+#include <memory>
+#include <span>
+#include <vector>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+struct SceneHit
+{
+    float t = std::numeric_limits<float>::infinity();
+    // (max) for the windows.h macro
+    uint32_t instance = (std::numeric_limits<uint32_t>::max)();
+    uint32_t triangle = (std::numeric_limits<uint32_t>::max)();
+    // barycentric weights of the second and the third vertex
+    float u = 0;
+    float v = 0;
+
+    bool IsHit() const
+    {
+        return instance != (std::numeric_limits<uint32_t>::max)();
+    }
+};
+
+///
+/// two level picking. a Bvh of instances (top level) over the MeshBvh of each mesh (bottom level).
+///
+/// auto id = scene.AddInstance(meshBvh, transform);
+/// scene.SetTransform(id, moved);
+/// scene.Update(); // refit. rebuild when the tree got too loose
+/// auto hit = scene.Intersect(ray);
+///
+/// meshes are shared between instances and are not copied.
+///
+class SceneBvh
+{
+    struct Instance
+    {
+        std::shared_ptr<const MeshBvh> mesh;
+        falg::Transform transform;
+        falg::AABB bounds;
+    };
+    std::vector<Instance> m_instances;
+    std::vector<uint32_t> m_freeInstances;
+
+    Bvh m_bvh;
+    // Bvh primitive to instance
+    std::vector<uint32_t> m_primitives;
+    std::vector<falg::AABB> m_bounds;
+    float m_builtCost = 0;
+    bool m_rebuild = false;
+    bool m_refit = false;
+
+    void Rebuild()
+    {
+        m_primitives.clear();
+        m_bounds.clear();
+        for (uint32_t i = 0; i < m_instances.size(); ++i)
+        {
+            auto &instance = m_instances[i];
+            // removed or no triangles
+            if (instance.mesh && !instance.bounds.IsEmpty())
+            {
+                m_primitives.push_back(i);
+                m_bounds.push_back(instance.bounds);
+            }
+        }
+        m_bvh.Build(m_bounds, 2);
+        m_builtCost = m_bvh.Cost();
+    }
+
+    // a removed instance has no mesh
+    Instance &Find(uint32_t id)
+    {
+        if (id >= m_instances.size() || !m_instances[id].mesh)
+        {
+            throw std::runtime_error("instance not found");
+        }
+        return m_instances[id];
+    }
+
+    const Instance &Find(uint32_t id) const
+    {
+        if (id >= m_instances.size() || !m_instances[id].mesh)
+        {
+            throw std::runtime_error("instance not found");
+        }
+        return m_instances[id];
+    }
+
+public:
+    // Update rebuilds when the SAH cost of the refitted tree grows by this ratio
+    float RebuildRatio = 1.5f;
+
+    const Bvh &Tree() const
+    {
+        return m_bvh;
+    }
+
+    size_t InstanceCount() const
+    {
+        return m_instances.size() - m_freeInstances.size();
+    }
+
+    uint32_t AddInstance(const std::shared_ptr<const MeshBvh> &mesh, const falg::Transform &transform = {})
+    {
+        if (!mesh)
+        {
+            throw std::runtime_error("no mesh");
+        }
+        uint32_t id;
+        if (m_freeInstances.empty())
+        {
+            id = static_cast<uint32_t>(m_instances.size());
+            m_instances.push_back({});
+        }
+        else
+        {
+            id = m_freeInstances.back();
+            m_freeInstances.pop_back();
+        }
+        m_instances[id] = {mesh, transform, mesh->Bounds().Transform(transform)};
+        m_rebuild = true;
+        return id;
+    }
+
+    void RemoveInstance(uint32_t id)
+    {
+        Find(id) = {};
+        m_freeInstances.push_back(id);
+        m_rebuild = true;
+    }
+
+    const falg::Transform &GetTransform(uint32_t id) const
+    {
+        return Find(id).transform;
+    }
+
+    void SetTransform(uint32_t id, const falg::Transform &transform)
+    {
+        auto &instance = Find(id);
+        instance.transform = transform;
+        instance.bounds = instance.mesh->Bounds().Transform(transform);
+        m_refit = true;
+    }
+
+    // the bottom level changed. MeshBvh::Refit or a new mesh
+    void SetMesh(uint32_t id, const std::shared_ptr<const MeshBvh> &mesh)
+    {
+        if (!mesh)
+        {
+            throw std::runtime_error("no mesh");
+        }
+        auto &instance = Find(id);
+        auto wasEmpty = instance.bounds.IsEmpty();
+        instance.mesh = mesh;
+        instance.bounds = mesh->Bounds().Transform(instance.transform);
+        if (wasEmpty != instance.bounds.IsEmpty())
+        {
+            m_rebuild = true;
+        }
+        m_refit = true;
+    }
+
+    // world box of the instance
+    const falg::AABB &Bounds(uint32_t id) const
+    {
+        return Find(id).bounds;
+    }
+
+    ///
+    /// apply the changes to the top level.
+    /// refit after SetTransform. rebuild after Add / Remove or when the refit cost exceeds RebuildRatio.
+    /// returns true if rebuilt
+    ///
+    bool Update()
+    {
+        if (m_rebuild)
+        {
+            Rebuild();
+            m_rebuild = false;
+            m_refit = false;
+            return true;
+        }
+        if (!m_refit)
+        {
+            return false;
+        }
+        m_refit = false;
+        for (size_t i = 0; i < m_primitives.size(); ++i)
+        {
+            m_bounds[i] = m_instances[m_primitives[i]].bounds;
+        }
+        m_bvh.Refit(m_bounds);
+        if (m_bvh.Cost() > m_builtCost * RebuildRatio)
+        {
+            Rebuild();
+            return true;
+        }
+        return false;
+    }
+
+    // nearest hit closer than maxT. valid after Update
+    SceneHit Intersect(const falg::Ray &ray, float maxT = std::numeric_limits<float>::infinity()) const
+    {
+        SceneHit hit;
+        auto t = maxT;
+        auto order = m_bvh.Indices();
+        m_bvh.Traverse(ray, t, [&](uint32_t first, uint32_t count) {
+            for (auto i = first; i < first + count; ++i)
+            {
+                auto id = m_primitives[order[i]];
+                auto &instance = m_instances[id];
+                // rigid transform. t is the same in the local space
+                auto meshHit = instance.mesh->Intersect(ray.ToLocal(instance.transform), t);
+                if (meshHit.IsHit())
+                {
+                    t = meshHit.t;
+                    hit = {meshHit.t, id, meshHit.triangle, meshHit.u, meshHit.v};
+                }
+            }
+        });
+        return hit;
+    }
+};
+
+} // namespace wgut::scene
@@ -0,0 +1,279 @@
+#pragma once
+#include "TransformStore.h"
+#include <falg.h>
+#include <algorithm>
+#include <barrier>
+#include <span>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+///
+/// flattened hierarchy. node id is the index of every array and a parent always has a smaller id than its children.
+///
+/// auto root = graph.AddNode(SceneGraph::NO_PARENT, {});
+/// auto child = graph.AddNode(root, trs);
+/// graph.SetLocal(root, moved); // root and child are dirty
+/// graph.Update(); // recompute the dirty subtrees only
+/// auto worlds = graph.Worlds(); // contiguous float16 for a constant buffer
+///
+/// world = local * parent world (row vector)
+///
+class SceneGraph
+{
+public:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+private:
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_depths;
+    // children as a linked list
+    std::vector<uint32_t> m_firstChild;
+    std::vector<uint32_t> m_nextSibling;
+    std::vector<falg::TRS> m_locals;
+    AlignedVector<falg::float16> m_worlds;
+
+    std::vector<uint8_t> m_dirty;
+    std::vector<uint32_t> m_dirtyRoots;
+    // work buffers
+    std::vector<uint32_t> m_stack;
+    std::vector<std::vector<uint32_t>> m_levels;
+    uint32_t m_maxDepth = 0;
+
+    void ComputeWorld(uint32_t node)
+    {
+        auto local = m_locals[node].RowMatrix();
+        auto parent = m_parents[node];
+        m_worlds[node] = parent == NO_PARENT ? local : falg::RowMatrixMul(local, m_worlds[parent]);
+    }
+
+    // visit each dirty subtree once. parents before children
+    template <typename F>
+    size_t EachDirtyNode(const F &f)
+    {
+        // an ancestor has a smaller id. its walk clears the dirty bits of the descendants
+        std::sort(m_dirtyRoots.begin(), m_dirtyRoots.end());
+        size_t count = 0;
+        for (auto root : m_dirtyRoots)
+        {
+            if (!m_dirty[root])
+            {
+                continue;
+            }
+            m_stack.push_back(root);
+            while (!m_stack.empty())
+            {
+                auto node = m_stack.back();
+                m_stack.pop_back();
+                m_dirty[node] = 0;
+                f(node);
+                ++count;
+                for (auto child = m_firstChild[node]; child != NO_PARENT; child = m_nextSibling[child])
+                {
+                    m_stack.push_back(child);
+                }
+            }
+        }
+        m_dirtyRoots.clear();
+        return count;
+    }
+
+public:
+    size_t Size() const
+    {
+        return m_parents.size();
+    }
+
+    void Reserve(size_t n)
+    {
+        m_parents.reserve(n);
+        m_depths.reserve(n);
+        m_firstChild.reserve(n);
+        m_nextSibling.reserve(n);
+        m_locals.reserve(n);
+        m_worlds.reserve(n);
+        m_dirty.reserve(n);
+    }
+
+    void Clear()
+    {
+        m_parents.clear();
+        m_depths.clear();
+        m_firstChild.clear();
+        m_nextSibling.clear();
+        m_locals.clear();
+        m_worlds.clear();
+        m_dirty.clear();
+        m_dirtyRoots.clear();
+        m_maxDepth = 0;
+    }
+
+    uint32_t AddNode(uint32_t parent, const falg::TRS &local = {})
+    {
+        auto node = static_cast<uint32_t>(m_parents.size());
+        if (parent != NO_PARENT && parent >= node)
+        {
+            throw std::runtime_error("parent not found");
+        }
+        auto depth = parent == NO_PARENT ? 0 : m_depths[parent] + 1;
+        m_maxDepth = std::max(m_maxDepth, depth);
+        m_parents.push_back(parent);
+        m_depths.push_back(depth);
+        m_firstChild.push_back(NO_PARENT);
+        m_nextSibling.push_back(NO_PARENT);
+        if (parent != NO_PARENT)
+        {
+            m_nextSibling[node] = m_firstChild[parent];
+            m_firstChild[parent] = node;
+        }
+        m_locals.push_back(local);
+        m_worlds.push_back(falg::IdentityMatrix());
+        m_dirty.push_back(0);
+        MarkDirty(node);
+        return node;
+    }
+
+    uint32_t Parent(uint32_t node) const
+    {
+        return m_parents[node];
+    }
+
+    uint32_t Depth(uint32_t node) const
+    {
+        return m_depths[node];
+    }
+
+    std::span<const uint32_t> Parents() const
+    {
+        return m_parents;
+    }
+
+    const falg::TRS &Local(uint32_t node) const
+    {
+        return m_locals[node];
+    }
+
+    void SetLocal(uint32_t node, const falg::TRS &local)
+    {
+        m_locals[node] = local;
+        MarkDirty(node);
+    }
+
+    // the subtree of node is recomputed by the next Update
+    void MarkDirty(uint32_t node)
+    {
+        if (!m_dirty[node])
+        {
+            m_dirty[node] = 1;
+            m_dirtyRoots.push_back(node);
+        }
+    }
+
+    bool IsDirty(uint32_t node) const
+    {
+        return m_dirty[node] != 0;
+    }
+
+    // valid after Update
+    const falg::float16 &World(uint32_t node) const
+    {
+        return m_worlds[node];
+    }
+
+    std::span<const falg::float16> Worlds() const
+    {
+        return m_worlds;
+    }
+
+    // for the parent argument of gizmo::handle. scale of the parent is dropped
+    falg::Transform ParentTransform(uint32_t node) const
+    {
+        auto parent = m_parents[node];
+        if (parent == NO_PARENT)
+        {
+            return {};
+        }
+        auto trs = falg::RowMatrixDecompose(m_worlds[parent]);
+        return {trs.translation, trs.rotation};
+    }
+
+    // recompute the dirty subtrees. returns the number of recomputed nodes
+    size_t Update()
+    {
+        return EachDirtyNode([this](uint32_t node) { ComputeWorld(node); });
+    }
+
+    // recompute every node in id order
+    void UpdateAll()
+    {
+        falg::ComposeTRS(m_locals, m_worlds);
+        for (uint32_t node = 0; node < m_parents.size(); ++node)
+        {
+            auto parent = m_parents[node];
+            if (parent != NO_PARENT)
+            {
+                m_worlds[node] = falg::RowMatrixMul(m_worlds[node], m_worlds[parent]);
+            }
+        }
+        std::fill(m_dirty.begin(), m_dirty.end(), 0);
+        m_dirtyRoots.clear();
+    }
+
+    ///
+    /// Update with threads. the dirty nodes are grouped by depth and each level is split across the threads.
+    /// a level waits for the previous one. small updates run on the calling thread.
+    ///
+    size_t UpdateParallel(uint32_t threadCount = std::thread::hardware_concurrency(), size_t minNodesPerThread = 4096)
+    {
+        m_levels.resize(m_maxDepth + 1);
+        for (auto &level : m_levels)
+        {
+            level.clear();
+        }
+        auto count = EachDirtyNode([this](uint32_t node) { m_levels[m_depths[node]].push_back(node); });
+
+        threadCount = static_cast<uint32_t>(std::min<size_t>(std::max(threadCount, 1u), count / minNodesPerThread));
+        if (threadCount <= 1)
+        {
+            for (auto &level : m_levels)
+            {
+                for (auto node : level)
+                {
+                    ComputeWorld(node);
+                }
+            }
+            return count;
+        }
+
+        std::barrier sync(threadCount);
+        auto worker = [this, threadCount, &sync](uint32_t index) {
+            for (auto &level : m_levels)
+            {
+                auto begin = level.size() * index / threadCount;
+                auto end = level.size() * (index + 1) / threadCount;
+                for (auto i = begin; i < end; ++i)
+                {
+                    ComputeWorld(level[i]);
+                }
+                sync.arrive_and_wait();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back(worker, i);
+        }
+        worker(0);
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        return count;
+    }
+};
+
+} // namespace wgut::scene
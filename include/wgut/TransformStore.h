@@ -0,0 +1,293 @@
+#pragma once
+#include <falg.h>
+#include <new>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace wgut::scene
+{
+
+template <typename T, size_t ALIGN = 64>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, ALIGN>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGN> &)
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(ALIGN)));
+    }
+
+    void deallocate(T *p, size_t)
+    {
+        ::operator delete(p, std::align_val_t(ALIGN));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, ALIGN> &) const
+    {
+        return true;
+    }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// index into the slot table and the generation of the slot. survives swap-remove of other transforms
+struct TransformHandle
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const TransformHandle &rhs) const
+    {
+        return index == rhs.index && generation == rhs.generation;
+    }
+};
+
+///
+/// TRS of many objects in separated, 64 byte aligned arrays.
+///
+/// auto h = store.Create(trs);
+/// store.SetTranslation(h, {1, 2, 3});
+/// auto matrices = store.UpdateMatrices(); // contiguous float16 for a constant buffer
+/// store.Destroy(h); // the last one moves into the hole
+///
+/// the arrays are dense. dense index i of every array is the same object.
+///
+class TransformStore
+{
+    AlignedVector<float> m_tx, m_ty, m_tz;
+    AlignedVector<float> m_rx, m_ry, m_rz, m_rw;
+    AlignedVector<float> m_sx, m_sy, m_sz;
+    AlignedVector<falg::float16> m_matrices;
+    // dense index to slot
+    std::vector<uint32_t> m_slotOf;
+
+    struct Slot
+    {
+        uint32_t dense;
+        uint32_t generation;
+    };
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+
+    template <typename F>
+    void EachArray(const F &f)
+    {
+        f(m_tx);
+        f(m_ty);
+        f(m_tz);
+        f(m_rx);
+        f(m_ry);
+        f(m_rz);
+        f(m_rw);
+        f(m_sx);
+        f(m_sy);
+        f(m_sz);
+    }
+
+public:
+    size_t Size() const
+    {
+        return m_slotOf.size();
+    }
+
+    void Reserve(size_t n)
+    {
+        EachArray([n](auto &a) { a.reserve(n); });
+        m_matrices.reserve(n);
+        m_slotOf.reserve(n);
+        m_slots.reserve(n);
+    }
+
+    TransformHandle Create(const falg::TRS &trs = {})
+    {
+        uint32_t index;
+        if (m_freeSlots.empty())
+        {
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({0, 0});
+        }
+        else
+        {
+            index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        auto dense = static_cast<uint32_t>(m_slotOf.size());
+        m_slots[index].dense = dense;
+        m_slotOf.push_back(index);
+
+        EachArray([](auto &a) { a.push_back(0); });
+        m_matrices.push_back(falg::IdentityMatrix());
+        Set(dense, trs);
+        return {index, m_slots[index].generation};
+    }
+
+    bool IsAlive(const TransformHandle &handle) const
+    {
+        return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+    }
+
+    uint32_t DenseIndex(const TransformHandle &handle) const
+    {
+        if (!IsAlive(handle))
+        {
+            throw std::runtime_error("invalid handle");
+        }
+        return m_slots[handle.index].dense;
+    }
+
+    TransformHandle HandleAt(uint32_t dense) const
+    {
+        auto index = m_slotOf[dense];
+        return {index, m_slots[index].generation};
+    }
+
+    // swap-remove. the last transform moves to the removed dense index
+    void Destroy(const TransformHandle &handle)
+    {
+        auto dense = DenseIndex(handle);
+        auto last = static_cast<uint32_t>(m_slotOf.size() - 1);
+        if (dense != last)
+        {
+            EachArray([dense, last](auto &a) { a[dense] = a[last]; });
+            m_matrices[dense] = m_matrices[last];
+            m_slotOf[dense] = m_slotOf[last];
+            m_slots[m_slotOf[dense]].dense = dense;
+        }
+        EachArray([](auto &a) { a.pop_back(); });
+        m_matrices.pop_back();
+        m_slotOf.pop_back();
+
+        // old handles to this slot become invalid
+        ++m_slots[handle.index].generation;
+        m_freeSlots.push_back(handle.index);
+    }
+
+    void Clear()
+    {
+        for (auto index : m_slotOf)
+        {
+            ++m_slots[index].generation;
+            m_freeSlots.push_back(index);
+        }
+        EachArray([](auto &a) { a.clear(); });
+        m_matrices.clear();
+        m_slotOf.clear();
+    }
+
+    falg::TRS Get(uint32_t dense) const
+    {
+        return {
+            {m_tx[dense], m_ty[dense], m_tz[dense]},
+            {m_rx[dense], m_ry[dense], m_rz[dense], m_rw[dense]},
+            {m_sx[dense], m_sy[dense], m_sz[dense]},
+        };
+    }
+
+    falg::TRS Get(const TransformHandle &handle) const
+    {
+        return Get(DenseIndex(handle));
+    }
+
+    void Set(uint32_t dense, const falg::TRS &trs)
+    {
+        SetTranslation(dense, trs.translation);
+        SetRotation(dense, trs.rotation);
+        SetScale(dense, trs.scale);
+    }
+
+    void Set(const TransformHandle &handle, const falg::TRS &trs)
+    {
+        Set(DenseIndex(handle), trs);
+    }
+
+    void SetTranslation(uint32_t dense, const falg::float3 &t)
+    {
+        m_tx[dense] = t[0];
+        m_ty[dense] = t[1];
+        m_tz[dense] = t[2];
+    }
+
+    void SetTranslation(const TransformHandle &handle, const falg::float3 &t)
+    {
+        SetTranslation(DenseIndex(handle), t);
+    }
+
+    void SetRotation(uint32_t dense, const falg::float4 &r)
+    {
+        m_rx[dense] = r[0];
+        m_ry[dense] = r[1];
+        m_rz[dense] = r[2];
+        m_rw[dense] = r[3];
+    }
+
+    void SetRotation(const TransformHandle &handle, const falg::float4 &r)
+    {
+        SetRotation(DenseIndex(handle), r);
+    }
+
+    void SetScale(uint32_t dense, const falg::float3 &s)
+    {
+        m_sx[dense] = s[0];
+        m_sy[dense] = s[1];
+        m_sz[dense] = s[2];
+    }
+
+    void SetScale(const TransformHandle &handle, const falg::float3 &s)
+    {
+        SetScale(DenseIndex(handle), s);
+    }
+
+    // direct access for batch kernels
+    falg::xyz_span<float> Translations()
+    {
+        return {m_tx, m_ty, m_tz};
+    }
+
+    falg::xyz_span<float> Scales()
+    {
+        return {m_sx, m_sy, m_sz};
+    }
+
+    falg::trs_span View() const
+    {
+        return {
+            {m_tx, m_ty, m_tz},
+            m_rx,
+            m_ry,
+            m_rz,
+            m_rw,
+            {m_sx, m_sy, m_sz},
+        };
+    }
+
+    // TRS::RowMatrix of all transforms in dense order
+    std::span<const falg::float16> UpdateMatrices()
+    {
+        falg::ComposeTRS(View(), m_matrices);
+        return m_matrices;
+    }
+
+    // result of the last UpdateMatrices
+    std::span<const falg::float16> Matrices() const
+    {
+        return m_matrices;
+    }
+};
+
+} // namespace wgut::scene
@@ -49,11 +49,26 @@ uint32_t hash_fnv1a(const std::string &str);
 
 #include "falg.h"
 
+namespace wgut::scene
+{
+class KdTree;
+}
+
 namespace wgut::gizmo::handle
 {
 
+// vertex snapping for translation
+struct TranslationSnap
+{
+    // world positions of the scene vertices. see wgut/KdTree.h
+    const scene::KdTree *vertices = nullptr;
+    // the dragged position moves to the nearest vertex within this world distance
+    float distance = 0.1f;
+};
+
 bool translation(const GizmoSystem &system, uint32_t id, bool is_local,
-                 const falg::Transform *parent, falg::float3 &t, const falg::float4 &r);
+                 const falg::Transform *parent, falg::float3 &t, const falg::float4 &r,
+                 const TranslationSnap *snap = nullptr);
 bool rotation(const GizmoSystem &system, uint32_t id, bool is_local,
               const falg::Transform *parent, const falg::float3 &t, falg::float4 &r);
 bool scale(const GizmoSystem &system, uint32_t id, bool is_uniform,
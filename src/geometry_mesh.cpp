@@ -1,190 +1,396 @@
-#include "geometry_mesh.h"
-
-static const float tau = 6.28318530718f;
-
-namespace wgut::gizmo
-{
-
-void geometry_mesh::compute_normals()
-{
-    static const double NORMAL_EPSILON = 0.0001;
-
-    std::vector<uint32_t> uniqueVertIndices(this->vertices.size(), 0);
-    for (uint32_t i = 0; i < uniqueVertIndices.size(); ++i)
-    {
-        if (uniqueVertIndices[i] == 0)
-        {
-            uniqueVertIndices[i] = i + 1;
-            auto v0 = this->vertices[i].position;
-            for (auto j = i + 1; j < this->vertices.size(); ++j)
-            {
-                auto v1 = this->vertices[j].position;
-                if (falg::Length(v1 - v0) < NORMAL_EPSILON)
-                {
-                    uniqueVertIndices[j] = uniqueVertIndices[i];
-                }
-            }
-        }
-    }
-
-    uint32_t idx0, idx1, idx2;
-    for (auto t = triangles.begin(); t != triangles.end(); t += 3)
-    {
-        idx0 = uniqueVertIndices[t[0]] - 1;
-        idx1 = uniqueVertIndices[t[1]] - 1;
-        idx2 = uniqueVertIndices[t[2]] - 1;
-
-        geometry_vertex &v0 = this->vertices[idx0], &v1 = this->vertices[idx1], &v2 = this->vertices[idx2];
-        auto n = falg::Cross(v1.position - v0.position, v2.position - v0.position);
-        v0.normal += n;
-        v1.normal += n;
-        v2.normal += n;
-    }
-
-    for (uint32_t i = 0; i < this->vertices.size(); ++i)
-        this->vertices[i].normal = this->vertices[uniqueVertIndices[i] - 1].normal;
-    for (geometry_vertex &v : this->vertices)
-        v.normal = falg::Normalize(v.normal);
-}
-
-geometry_mesh geometry_mesh::make_box_geometry(const falg::float3 &min_bounds, const falg::float3 &max_bounds)
-{
-    auto a = min_bounds;
-    auto b = max_bounds;
-    geometry_mesh mesh;
-    mesh.vertices = {
-        {{a[0], a[1], a[2]}, {-1, 0, 0}},
-        {{a[0], a[1], b[2]}, {-1, 0, 0}},
-        {{a[0], b[1], b[2]}, {-1, 0, 0}},
-        {{a[0], b[1], a[2]}, {-1, 0, 0}},
-        {{b[0], a[1], a[2]}, {+1, 0, 0}},
-        {{b[0], b[1], a[2]}, {+1, 0, 0}},
-        {{b[0], b[1], b[2]}, {+1, 0, 0}},
-        {{b[0], a[1], b[2]}, {+1, 0, 0}},
-        {{a[0], a[1], a[2]}, {0, -1, 0}},
-        {{b[0], a[1], a[2]}, {0, -1, 0}},
-        {{b[0], a[1], b[2]}, {0, -1, 0}},
-        {{a[0], a[1], b[2]}, {0, -1, 0}},
-        {{a[0], b[1], a[2]}, {0, +1, 0}},
-        {{a[0], b[1], b[2]}, {0, +1, 0}},
-        {{b[0], b[1], b[2]}, {0, +1, 0}},
-        {{b[0], b[1], a[2]}, {0, +1, 0}},
-        {{a[0], a[1], a[2]}, {0, 0, -1}},
-        {{a[0], b[1], a[2]}, {0, 0, -1}},
-        {{b[0], b[1], a[2]}, {0, 0, -1}},
-        {{b[0], a[1], a[2]}, {0, 0, -1}},
-        {{a[0], a[1], b[2]}, {0, 0, +1}},
-        {{b[0], a[1], b[2]}, {0, 0, +1}},
-        {{b[0], b[1], b[2]}, {0, 0, +1}},
-        {{a[0], b[1], b[2]}, {0, 0, +1}},
-    };
-    std::array<uint32_t, 3> triangles[] = {{0, 1, 2}, {0, 2, 3}, {4, 5, 6}, {4, 6, 7}, {8, 9, 10}, {8, 10, 11}, {12, 13, 14}, {12, 14, 15}, {16, 17, 18}, {16, 18, 19}, {20, 21, 22}, {20, 22, 23}};
-    auto begin = (uint32_t *)triangles;
-    auto end = begin + _countof(triangles) * 3;
-    mesh.triangles.assign(begin, end);
-    return mesh;
-}
-
-geometry_mesh geometry_mesh::make_cylinder_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, uint32_t slices)
-{
-    // Generated curved surface
-    geometry_mesh mesh;
-
-    for (uint32_t i = 0; i <= slices; ++i)
-    {
-        const float tex_s = static_cast<float>(i) / slices, angle = (float)(i % slices) * tau / slices;
-        auto arm = arm1 * std::cos(angle) + arm2 * std::sin(angle);
-        mesh.vertices.push_back({arm, falg::Normalize(arm)});
-        mesh.vertices.push_back({arm + axis, falg::Normalize(arm)});
-    }
-    for (uint32_t i = 0; i < slices; ++i)
-    {
-        mesh.triangles.push_back(i * 2);
-        mesh.triangles.push_back(i * 2 + 2);
-        mesh.triangles.push_back(i * 2 + 3);
-
-        mesh.triangles.push_back(i * 2);
-        mesh.triangles.push_back(i * 2 + 3);
-        mesh.triangles.push_back(i * 2 + 1);
-    }
-
-    // Generate caps
-    uint32_t base = (uint32_t)mesh.vertices.size();
-    for (uint32_t i = 0; i < slices; ++i)
-    {
-        const float angle = static_cast<float>(i % slices) * tau / slices, c = std::cos(angle), s = std::sin(angle);
-        auto arm = arm1 * c + arm2 * s;
-        mesh.vertices.push_back({arm + axis, falg::Normalize(axis)});
-        mesh.vertices.push_back({arm, -falg::Normalize(axis)});
-    }
-    for (uint32_t i = 2; i < slices; ++i)
-    {
-        mesh.triangles.push_back(base);
-        mesh.triangles.push_back(base + i * 2 - 2);
-        mesh.triangles.push_back(base + i * 2);
-
-        mesh.triangles.push_back(base + 1);
-        mesh.triangles.push_back(base + i * 2 + 1);
-        mesh.triangles.push_back(base + i * 2 - 1);
-    }
-    return mesh;
-}
-
-geometry_mesh geometry_mesh::make_lathed_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, int slices,
-                                                  const falg::float2 *points, uint32_t pointCount, const float eps)
-{
-    geometry_mesh mesh;
-    for (int i = 0; i <= slices; ++i)
-    {
-        const float angle = (static_cast<float>(i % slices) * tau / slices) + (tau / 8.f);
-        const float c = std::cos(angle);
-        const float s = std::sin(angle);
-        falg::Matrix2x3 mat{axis, arm1 * c + arm2 * s};
-        for (uint32_t j = 0; j < pointCount; ++j)
-        {
-            auto &p = points[j];
-            // 2D to 3D
-            auto v = mat.Apply(p) + falg::float3{eps, eps, eps};
-            mesh.vertices.push_back({v, {0, 0, 0}});
-        }
-
-        if (i > 0)
-        {
-            for (uint32_t j = 1; j < pointCount; ++j)
-            {
-                uint32_t i0 = (i - 1) * pointCount + (j - 1);
-                uint32_t i1 = (i - 0) * pointCount + (j - 1);
-                uint32_t i2 = (i - 0) * pointCount + (j - 0);
-                uint32_t i3 = (i - 1) * pointCount + (j - 0);
-                mesh.triangles.push_back(i0);
-                mesh.triangles.push_back(i1);
-                mesh.triangles.push_back(i2);
-
-                mesh.triangles.push_back(i0);
-                mesh.triangles.push_back(i2);
-                mesh.triangles.push_back(i3);
-            }
-        }
-    }
-    mesh.compute_normals();
-    return mesh;
-}
-
-float operator>>(const falg::Ray &ray, const geometry_mesh &mesh)
-{
-    float best_t = std::numeric_limits<float>::infinity();
-    for (auto it = mesh.triangles.begin(); it != mesh.triangles.end(); it += 3)
-    {
-        auto t = ray >> falg::Triangle{
-                            falg::size_cast<falg::float3>(mesh.vertices[it[0]].position),
-                            falg::size_cast<falg::float3>(mesh.vertices[it[1]].position),
-                            falg::size_cast<falg::float3>(mesh.vertices[it[2]].position)};
-        if (t < best_t)
-        {
-            best_t = t;
-        }
-    }
-    return best_t;
-}
-
+#include "geometry_mesh.h"
+#include <falg_dispatch.h>
+#include <thread>
+
+static const float tau = 6.28318530718f;
+
+namespace wgut::gizmo
+{
+
+// split [0, count) across threads. small counts run on the calling thread
+template <typename F>
+static void parallel_for(size_t count, const F &f)
+{
+    static const size_t MIN_PER_THREAD = 16384;
+    auto threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count / MIN_PER_THREAD);
+    if (threadCount <= 1)
+    {
+        f(0, count);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(f, count * i / threadCount, count * (i + 1) / threadCount);
+    }
+    f(0, count / threadCount);
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+void geometry_mesh::compute_normals()
+{
+    static const double NORMAL_EPSILON = 0.0001;
+
+    // the first vertex of each coincident group accumulates the normal
+    std::vector<uint32_t> roots(vertices.size());
+    wgut::mesh::WeldVertices(std::span<const geometry_vertex>(vertices), &geometry_vertex::position, roots, NORMAL_EPSILON);
+
+    auto triangleCount = triangles.size() / 3;
+    std::vector<falg::float3> faces(triangleCount);
+    parallel_for(triangleCount, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            auto &v0 = vertices[roots[triangles[i * 3]]];
+            auto &v1 = vertices[roots[triangles[i * 3 + 1]]];
+            auto &v2 = vertices[roots[triangles[i * 3 + 2]]];
+            faces[i] = falg::Cross(v1.position - v0.position, v2.position - v0.position);
+        }
+    });
+
+    // the faces of each group in triangle order. a group sums in the same order as a serial loop over the triangles
+    std::vector<uint32_t> offsets(vertices.size() + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        ++offsets[roots[triangles[i]] + 1];
+    }
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<uint32_t> groupFaces(triangleCount * 3);
+    {
+        auto cursor = offsets;
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            groupFaces[cursor[roots[triangles[i]]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    parallel_for(vertices.size(), [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            for (auto j = offsets[i]; j < offsets[i + 1]; ++j)
+            {
+                vertices[i].normal += faces[groupFaces[j]];
+            }
+        }
+    });
+    // the others read the first vertex before it is normalized
+    parallel_for(vertices.size(), [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            if (roots[i] != i)
+            {
+                vertices[i].normal = falg::Normalize(vertices[roots[i]].normal);
+            }
+        }
+    });
+    parallel_for(vertices.size(), [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            if (roots[i] == i)
+            {
+                vertices[i].normal = falg::Normalize(vertices[i].normal);
+            }
+        }
+    });
+}
+
+geometry_mesh &geometry_mesh::weld(double epsilon)
+{
+    std::vector<uint32_t> roots(vertices.size());
+    auto count = wgut::mesh::WeldVertices(std::span<const geometry_vertex>(vertices), &geometry_vertex::position, roots, epsilon);
+
+    // keep the first vertices in order
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<geometry_vertex> welded;
+    welded.reserve(count);
+    for (uint32_t i = 0; i < vertices.size(); ++i)
+    {
+        if (roots[i] == i)
+        {
+            remap[i] = static_cast<uint32_t>(welded.size());
+            welded.push_back(vertices[i]);
+        }
+        else
+        {
+            remap[i] = remap[roots[i]];
+        }
+    }
+    for (auto &i : triangles)
+    {
+        i = remap[i];
+    }
+    vertices.swap(welded);
+    packets.reset();
+    bounds = {};
+    bvh.reset();
+    return *this;
+}
+
+wgut::mesh::VertexCacheResult geometry_mesh::optimize_vertex_cache(uint32_t cache_size)
+{
+    wgut::mesh::VertexCacheResult result;
+    result.before = wgut::mesh::AnalyzeVertexCache(std::span<const uint32_t>(triangles), vertices.size(), cache_size);
+    wgut::mesh::OptimizeVertexCache(std::span<uint32_t>(triangles), vertices.size(), cache_size);
+    result.after = wgut::mesh::AnalyzeVertexCache(std::span<const uint32_t>(triangles), vertices.size(), cache_size);
+    packets.reset();
+    bounds = {};
+    bvh.reset();
+    return result;
+}
+
+wgut::mesh::OverdrawResult geometry_mesh::optimize_overdraw(float threshold, uint32_t cache_size)
+{
+    std::vector<falg::float3> positions(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        positions[i] = vertices[i].position;
+    }
+    wgut::mesh::OverdrawResult result;
+    // compute_normals takes Cross(p1 - p0, p2 - p0) as the outward normal
+    auto front = wgut::mesh::FrontFace::CounterClockwise;
+    result.before = wgut::mesh::AnalyzeOverdraw(std::span<const uint32_t>(triangles), std::span<const falg::float3>(positions), front);
+    result.clusters = wgut::mesh::OptimizeOverdraw(std::span<uint32_t>(triangles), std::span<const falg::float3>(positions), front, threshold, cache_size);
+    result.after = wgut::mesh::AnalyzeOverdraw(std::span<const uint32_t>(triangles), std::span<const falg::float3>(positions), front);
+    packets.reset();
+    bounds = {};
+    bvh.reset();
+    return result;
+}
+
+wgut::mesh::VertexFetchResult geometry_mesh::optimize_vertex_fetch()
+{
+    std::vector<uint32_t> remap(vertices.size());
+    auto count = wgut::mesh::OptimizeVertexFetchRemap(std::span<uint32_t>(triangles), std::span<uint32_t>(remap));
+    std::vector<geometry_vertex> reordered(count);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        if (remap[i] != wgut::mesh::UNUSED_VERTEX)
+        {
+            reordered[remap[i]] = vertices[i];
+        }
+    }
+    wgut::mesh::VertexFetchResult result{vertices.size(), count, (vertices.size() - count) * sizeof(geometry_vertex)};
+    vertices.swap(reordered);
+    packets.reset();
+    bounds = {};
+    bvh.reset();
+    return result;
+}
+
+wgut::mesh::Meshlets geometry_mesh::build_meshlets(uint32_t max_vertices, uint32_t max_triangles) const
+{
+    wgut::mesh::Meshlets meshlets;
+    meshlets.Build(std::span<const geometry_vertex>(vertices), &geometry_vertex::position, std::span<const uint32_t>(triangles),
+                   wgut::mesh::FrontFace::CounterClockwise, max_vertices, max_triangles);
+    return meshlets;
+}
+
+geometry_mesh geometry_mesh::transformed(const falg::Transform &t) const
+{
+    geometry_mesh mesh;
+    mesh.vertices.resize(vertices.size());
+    falg::BatchApplyVertices(t.Basis(), std::span(vertices), std::span(mesh.vertices),
+                             &geometry_vertex::position, &geometry_vertex::normal);
+    mesh.triangles = triangles;
+    return mesh;
+}
+
+geometry_mesh geometry_mesh::make_box_geometry(const falg::float3 &min_bounds, const falg::float3 &max_bounds)
+{
+    auto a = min_bounds;
+    auto b = max_bounds;
+    geometry_mesh mesh;
+    mesh.vertices = {
+        {{a[0], a[1], a[2]}, {-1, 0, 0}},
+        {{a[0], a[1], b[2]}, {-1, 0, 0}},
+        {{a[0], b[1], b[2]}, {-1, 0, 0}},
+        {{a[0], b[1], a[2]}, {-1, 0, 0}},
+        {{b[0], a[1], a[2]}, {+1, 0, 0}},
+        {{b[0], b[1], a[2]}, {+1, 0, 0}},
+        {{b[0], b[1], b[2]}, {+1, 0, 0}},
+        {{b[0], a[1], b[2]}, {+1, 0, 0}},
+        {{a[0], a[1], a[2]}, {0, -1, 0}},
+        {{b[0], a[1], a[2]}, {0, -1, 0}},
+        {{b[0], a[1], b[2]}, {0, -1, 0}},
+        {{a[0], a[1], b[2]}, {0, -1, 0}},
+        {{a[0], b[1], a[2]}, {0, +1, 0}},
+        {{a[0], b[1], b[2]}, {0, +1, 0}},
+        {{b[0], b[1], b[2]}, {0, +1, 0}},
+        {{b[0], b[1], a[2]}, {0, +1, 0}},
+        {{a[0], a[1], a[2]}, {0, 0, -1}},
+        {{a[0], b[1], a[2]}, {0, 0, -1}},
+        {{b[0], b[1], a[2]}, {0, 0, -1}},
+        {{b[0], a[1], a[2]}, {0, 0, -1}},
+        {{a[0], a[1], b[2]}, {0, 0, +1}},
+        {{b[0], a[1], b[2]}, {0, 0, +1}},
+        {{b[0], b[1], b[2]}, {0, 0, +1}},
+        {{a[0], b[1], b[2]}, {0, 0, +1}},
+    };
+    std::array<uint32_t, 3> triangles[] = {{0, 1, 2}, {0, 2, 3}, {4, 5, 6}, {4, 6, 7}, {8, 9, 10}, {8, 10, 11}, {12, 13, 14}, {12, 14, 15}, {16, 17, 18}, {16, 18, 19}, {20, 21, 22}, {20, 22, 23}};
+    auto begin = (uint32_t *)triangles;
+    auto end = begin + std::size(triangles) * 3;
+    mesh.triangles.assign(begin, end);
+    return mesh;
+}
+
+geometry_mesh geometry_mesh::make_cylinder_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, uint32_t slices)
+{
+    // Generated curved surface
+    geometry_mesh mesh;
+
+    for (uint32_t i = 0; i <= slices; ++i)
+    {
+        const float tex_s = static_cast<float>(i) / slices, angle = (float)(i % slices) * tau / slices;
+        auto arm = arm1 * std::cos(angle) + arm2 * std::sin(angle);
+        mesh.vertices.push_back({arm, falg::Normalize(arm)});
+        mesh.vertices.push_back({arm + axis, falg::Normalize(arm)});
+    }
+    for (uint32_t i = 0; i < slices; ++i)
+    {
+        mesh.triangles.push_back(i * 2);
+        mesh.triangles.push_back(i * 2 + 2);
+        mesh.triangles.push_back(i * 2 + 3);
+
+        mesh.triangles.push_back(i * 2);
+        mesh.triangles.push_back(i * 2 + 3);
+        mesh.triangles.push_back(i * 2 + 1);
+    }
+
+    // Generate caps
+    uint32_t base = (uint32_t)mesh.vertices.size();
+    for (uint32_t i = 0; i < slices; ++i)
+    {
+        const float angle = static_cast<float>(i % slices) * tau / slices, c = std::cos(angle), s = std::sin(angle);
+        auto arm = arm1 * c + arm2 * s;
+        mesh.vertices.push_back({arm + axis, falg::Normalize(axis)});
+        mesh.vertices.push_back({arm, -falg::Normalize(axis)});
+    }
+    for (uint32_t i = 2; i < slices; ++i)
+    {
+        mesh.triangles.push_back(base);
+        mesh.triangles.push_back(base + i * 2 - 2);
+        mesh.triangles.push_back(base + i * 2);
+
+        mesh.triangles.push_back(base + 1);
+        mesh.triangles.push_back(base + i * 2 + 1);
+        mesh.triangles.push_back(base + i * 2 - 1);
+    }
+    return mesh;
+}
+
+geometry_mesh geometry_mesh::make_lathed_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, int slices,
+                                                  const falg::float2 *points, uint32_t pointCount, const float eps)
+{
+    geometry_mesh mesh;
+    for (int i = 0; i <= slices; ++i)
+    {
+        const float angle = (static_cast<float>(i % slices) * tau / slices) + (tau / 8.f);
+        const float c = std::cos(angle);
+        const float s = std::sin(angle);
+        falg::Matrix2x3 mat{axis, arm1 * c + arm2 * s};
+        for (uint32_t j = 0; j < pointCount; ++j)
+        {
+            auto &p = points[j];
+            // 2D to 3D
+            auto v = mat.Apply(p) + falg::float3{eps, eps, eps};
+            mesh.vertices.push_back({v, {0, 0, 0}});
+        }
+
+        if (i > 0)
+        {
+            for (uint32_t j = 1; j < pointCount; ++j)
+            {
+                uint32_t i0 = (i - 1) * pointCount + (j - 1);
+                uint32_t i1 = (i - 0) * pointCount + (j - 1);
+                uint32_t i2 = (i - 0) * pointCount + (j - 0);
+                uint32_t i3 = (i - 1) * pointCount + (j - 0);
+                mesh.triangles.push_back(i0);
+                mesh.triangles.push_back(i1);
+                mesh.triangles.push_back(i2);
+
+                mesh.triangles.push_back(i0);
+                mesh.triangles.push_back(i2);
+                mesh.triangles.push_back(i3);
+            }
+        }
+    }
+    mesh.compute_normals();
+    return mesh;
+}
+
+geometry_mesh &geometry_mesh::build_packets()
+{
+    packets = std::make_shared<std::vector<falg::TrianglePacket>>(
+        falg::BuildTrianglePackets(std::span<const geometry_vertex>(vertices), std::span<const uint32_t>(triangles), &geometry_vertex::position));
+    bounds = {};
+    for (auto &v : vertices)
+    {
+        bounds.Expand(v.position);
+    }
+    return *this;
+}
+
+geometry_mesh &geometry_mesh::build_bvh()
+{
+    auto built = std::make_shared<wgut::scene::MeshBvh>();
+    built->Build(std::span<const geometry_vertex>(vertices), std::span<const uint32_t>(triangles), &geometry_vertex::position);
+    bvh = built;
+    return *this;
+}
+
+geometry_mesh &geometry_mesh::refit_bvh()
+{
+    if (!bvh)
+    {
+        return build_bvh();
+    }
+    auto refitted = std::make_shared<wgut::scene::MeshBvh>(*bvh);
+    refitted->Refit(std::span<const geometry_vertex>(vertices), std::span<const uint32_t>(triangles), &geometry_vertex::position);
+    bvh = refitted;
+    return *this;
+}
+
+falg::RayHit raycast(const falg::Ray &ray, const geometry_mesh &mesh)
+{
+    if (mesh.bvh)
+    {
+        auto hit = mesh.bvh->Intersect(ray);
+        return {hit.t, hit.triangle};
+    }
+
+    if (mesh.packets)
+    {
+        if (std::isinf(ray >> mesh.bounds))
+        {
+            return {};
+        }
+        return falg::dispatch::IntersectTrianglePackets(ray, *mesh.packets);
+    }
+
+    falg::RayHit hit;
+    for (auto it = mesh.triangles.begin(); it != mesh.triangles.end(); it += 3)
+    {
+        auto t = ray >> falg::Triangle{
+                            falg::size_cast<falg::float3>(mesh.vertices[it[0]].position),
+                            falg::size_cast<falg::float3>(mesh.vertices[it[1]].position),
+                            falg::size_cast<falg::float3>(mesh.vertices[it[2]].position)};
+        if (t < hit.t)
+        {
+            hit.t = t;
+            hit.triangle = static_cast<uint32_t>((it - mesh.triangles.begin()) / 3);
+        }
+    }
+    return hit;
+}
+
+float operator>>(const falg::Ray &ray, const geometry_mesh &mesh)
+{
+    return raycast(ray, mesh).t;
+}
+
 } // namespace wgut::gizmo
\ No newline at end of file
@@ -1,35 +1,73 @@
-#pragma once
-#include <vector>
-#include <falg.h>
-
-namespace wgut::gizmo
-{
-
-struct geometry_vertex
-{
-    falg::float3 position;
-    falg::float3 normal;
-    falg::float4 color;
-};
-
-struct geometry_mesh
-{
-    std::vector<geometry_vertex> vertices;
-    std::vector<uint32_t> triangles;
-
-    static geometry_mesh make_box_geometry(const falg::float3 &min_bounds, const falg::float3 &max_bounds);
-    static geometry_mesh make_cylinder_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, uint32_t slices);
-    static geometry_mesh make_lathed_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, int slices, const falg::float2 *points, uint32_t pointCount, const float eps = 0.0f);
-
-    void compute_normals();
-
-    void clear()
-    {
-        vertices.clear();
-        triangles.clear();
-    }
-};
-
-float operator>>(const falg::Ray &ray, const geometry_mesh &mesh);
-
-} // namespace wgut::gizmo
+#pragma once
+#include <vector>
+#include <memory>
+#include <falg.h>
+#include <wgut/MeshBvh.h>
+#include <wgut/MeshOptimizer.h>
+#include <wgut/Meshlets.h>
+
+namespace wgut::gizmo
+{
+
+struct geometry_vertex
+{
+    falg::float3 position;
+    falg::float3 normal;
+    falg::float4 color;
+};
+
+struct geometry_mesh
+{
+    std::vector<geometry_vertex> vertices;
+    std::vector<uint32_t> triangles;
+    // SoA copy of triangles for raycast. build_packets() again after vertices or triangles changed
+    std::shared_ptr<const std::vector<falg::TrianglePacket>> packets;
+    // box of the vertices for early ray rejection. set by build_packets()
+    falg::AABB bounds;
+    // raycast uses this before packets. build_bvh() again after triangles changed, refit_bvh() after vertices moved
+    std::shared_ptr<const wgut::scene::MeshBvh> bvh;
+
+    static geometry_mesh make_box_geometry(const falg::float3 &min_bounds, const falg::float3 &max_bounds);
+    static geometry_mesh make_cylinder_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, uint32_t slices);
+    static geometry_mesh make_lathed_geometry(const falg::float3 &axis, const falg::float3 &arm1, const falg::float3 &arm2, int slices, const falg::float2 *points, uint32_t pointCount, const float eps = 0.0f);
+
+    void compute_normals();
+
+    // merge the vertices closer than epsilon into the first one of the group and rewrite triangles.
+    // packets and bvh are cleared
+    geometry_mesh &weld(double epsilon = 0.0001);
+
+    // reorder triangles for the post transform cache. packets and bvh are cleared
+    wgut::mesh::VertexCacheResult optimize_vertex_cache(uint32_t cache_size = 16);
+
+    // reorder clusters of the cache optimized triangles to reduce overdraw. packets and bvh are cleared
+    wgut::mesh::OverdrawResult optimize_overdraw(float threshold = 1.05f, uint32_t cache_size = 16);
+
+    // reorder vertices in the first use order of triangles and drop the unused ones. packets and bvh are cleared
+    wgut::mesh::VertexFetchResult optimize_vertex_fetch();
+
+    // clusters of at most max_vertices and max_triangles for culling. run optimize_vertex_cache first
+    wgut::mesh::Meshlets build_meshlets(uint32_t max_vertices = 64, uint32_t max_triangles = 124) const;
+
+    // copy with vertices transformed by t. without packets and bvh
+    geometry_mesh transformed(const falg::Transform &t) const;
+
+    geometry_mesh &build_packets();
+    geometry_mesh &build_bvh();
+    // copies of this mesh keep the old bvh
+    geometry_mesh &refit_bvh();
+
+    void clear()
+    {
+        vertices.clear();
+        triangles.clear();
+        packets.reset();
+        bounds = {};
+        bvh.reset();
+    }
+};
+
+falg::RayHit raycast(const falg::Ray &ray, const geometry_mesh &mesh);
+float operator>>(const falg::Ray &ray, const geometry_mesh &mesh);
+
+} // namespace wgut::gizmo